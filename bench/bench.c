@@ -0,0 +1,346 @@
+
+/* bench.c */
+
+// Suíte de benchmarks do Rody: gera cargas sintéticas em memória e mede
+// lexer, parser e execução separadamente. O resultado é emitido em JSON
+// na saída padrão para acompanhar regressões entre versões.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include "lexer.h"
+#include "parser.h"
+#include "interpreter.h"
+
+#ifndef RODY_BENCH_VERSION
+#define RODY_BENCH_VERSION "desconhecida"
+#endif
+
+// Tempo mínimo de medição de cada fase, em segundos
+#define BENCH_MIN_TIME 0.25
+
+// Buffer de texto que cresce conforme necessário
+typedef struct {
+    char* data;
+    size_t length;
+    size_t capacity;
+} Buffer;
+
+static void buffer_append(Buffer* buffer, const char* text) {
+    size_t len = strlen(text);
+    if (buffer->length + len + 1 > buffer->capacity) {
+        size_t capacity = buffer->capacity == 0 ? 4096 : buffer->capacity;
+        while (buffer->length + len + 1 > capacity) {
+            capacity *= 2;
+        }
+        buffer->data = (char*)realloc(buffer->data, capacity);
+        if (buffer->data == NULL) {
+            fprintf(stderr, "Erro: Falha na alocação de memória para o benchmark.\n");
+            exit(1);
+        }
+        buffer->capacity = capacity;
+    }
+    memcpy(buffer->data + buffer->length, text, len + 1);
+    buffer->length += len;
+}
+
+// Geradores de carga; scale multiplica o tamanho de cada uma
+
+// Muitas instruções curtas com todos os tipos de token numéricos
+static void gen_token_dense(Buffer* out, int scale) {
+    for (int i = 0; i < 20000 * scale; i++) {
+        char line[128];
+        snprintf(line, sizeof(line), "%d + 22 * (333 - %d) / 5 + 6.5 - 7;\n", i % 97, i % 13);
+        buffer_append(out, line);
+    }
+}
+
+// Expressões profundas: parênteses aninhados e cadeias longas
+static void gen_deep_expr(Buffer* out, int scale) {
+    for (int s = 0; s < 20 * scale; s++) {
+        for (int d = 0; d < 500; d++) {
+            buffer_append(out, "(1 + ");
+        }
+        buffer_append(out, "1");
+        for (int d = 0; d < 500; d++) {
+            buffer_append(out, ")");
+        }
+        buffer_append(out, ";\n");
+    }
+}
+
+// Aritmética inteira e mista em cadeias longas
+static void gen_arithmetic(Buffer* out, int scale) {
+    for (int s = 0; s < 2000 * scale; s++) {
+        for (int i = 1; i < 50; i++) {
+            char term[32];
+            snprintf(term, sizeof(term), "%d %c ", i, "+-*"[i % 3]);
+            buffer_append(out, term);
+        }
+        buffer_append(out, "1.5;\n");
+    }
+}
+
+// Literais de string (exercita alocação de lexemes e valores)
+static void gen_string_build(Buffer* out, int scale) {
+    for (int i = 0; i < 20000 * scale; i++) {
+        char line[128];
+        snprintf(line, sizeof(line), "\"linha %d do relatorio com algum texto de preenchimento\";\n", i);
+        buffer_append(out, line);
+    }
+}
+
+// Muitos identificadores distintos (ainda sem semântica de execução)
+static void gen_symbol_heavy(Buffer* out, int scale) {
+    for (int i = 0; i < 20000 * scale; i++) {
+        char line[160];
+        snprintf(line, sizeof(line), "variavel_%d + contador_%d * (total_%d - _tmp%d);\n", i, i % 101, i % 7, i);
+        buffer_append(out, line);
+    }
+}
+
+// Relatório com muitos fragmentos de print (a saída vai para /dev/null)
+static void gen_print_heavy(Buffer* out, int scale) {
+    for (int i = 0; i < 20000 * scale; i++) {
+        char line[160];
+        snprintf(line, sizeof(line), "print \"item \", %d, tab, %d * 3, tab, %d.25 / 2, tab, color green, \"ok\", color reset, br;\n",
+                 i, i, i % 1000);
+        buffer_append(out, line);
+    }
+}
+
+// Laços sobre intervalos e pipelines map/filter (nenhuma lista intermediária)
+static void gen_range_pipeline(Buffer* out, int scale) {
+    buffer_append(out, "soma = 0;\nv = [1, 2, 3, 4, 5, 6, 7, 8, 9, 10];\n");
+    for (int i = 0; i < 200 * scale; i++) {
+        char line[160];
+        snprintf(line, sizeof(line), "for x <- (0..%d).map(x: x * 3).filter(x: x > 100) { soma = soma + x; }\n", 1000 + i % 7);
+        buffer_append(out, line);
+        buffer_append(out, "for y <- v.map(y: y * y).filter(y: y > 10) { soma = soma - y; }\n");
+    }
+}
+
+// Chamadas recursivas de funções puras (o cache evita recalcular subchamadas)
+static void gen_pure_calls(Buffer* out, int scale) {
+    buffer_append(out, "fun fib(n) {\n    if n < 2 { return n; }\n    return fib(n - 1) + fib(n - 2);\n}\n");
+    buffer_append(out, "fun paths(r, c) {\n    if r == 0 { return 1; }\n    if c == 0 { return 1; }\n"
+                       "    return paths(r - 1, c) + paths(r, c - 1);\n}\n");
+    for (int i = 0; i < 50 * scale; i++) {
+        char line[96];
+        snprintf(line, sizeof(line), "x = fib(%d) + paths(%d, %d);\n", 20 + i % 10, 8 + i % 5, 8 + i % 3);
+        buffer_append(out, line);
+    }
+}
+
+// Descrição de uma carga
+typedef struct {
+    const char* name;
+    void (*generate)(Buffer* out, int scale);
+    int executable; // 0 se o interpretador ainda não suporta a carga
+} Workload;
+
+static const Workload workloads[] = {
+    { "token_dense", gen_token_dense, 1 },
+    { "deep_expr", gen_deep_expr, 1 },
+    { "arithmetic", gen_arithmetic, 1 },
+    { "string_build", gen_string_build, 1 },
+    { "symbol_heavy", gen_symbol_heavy, 0 },
+    { "print_heavy", gen_print_heavy, 1 },
+    { "range_pipeline", gen_range_pipeline, 1 },
+    { "pure_calls", gen_pure_calls, 1 },
+};
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Conta os nós de uma AST
+static long count_nodes(ASTNode* node) {
+    if (node == NULL) {
+        return 0;
+    }
+    long total = 1;
+    for (int i = 0; i < node->num_children; i++) {
+        total += count_nodes(node->children[i]);
+    }
+    return total;
+}
+
+// Alocador usado por todas as fases
+static Allocator allocator;
+
+// Destino da saída do print durante a execução
+static int null_fd = -1;
+
+// Fase 1: apenas o lexer
+static long run_lex(const char* source) {
+    Lexer lexer;
+    lexer_init(&lexer, source, &allocator);
+    long tokens = 0;
+    for (;;) {
+        Token token = lexer_next_token(&lexer);
+        TokenType type = token.type;
+        token_free(&allocator, &token);
+        tokens++;
+        if (type == TOKEN_EOF || type == TOKEN_ERROR) {
+            break;
+        }
+    }
+    return tokens;
+}
+
+// Fase 2: lexer + parser (retorna a AST)
+static ASTNode* run_parse(const char* source) {
+    Lexer lexer;
+    lexer_init(&lexer, source, &allocator);
+    Parser parser;
+    parser_init(&parser, &lexer);
+    ASTNode* ast = parse(&parser);
+    if (ast == NULL) {
+        fprintf(stderr, "%s\n", parser.error.message);
+        exit(1);
+    }
+    return ast;
+}
+
+// Fase 3: execução de uma AST já construída
+static int run_execute(ASTNode* ast) {
+    Interpreter interp;
+    interpreter_init(&interp, &allocator);
+    output_set_fd(&interp.output, null_fd, 0);
+    Value value = interpret(&interp, ast);
+    free_value(&allocator, value);
+    int ok = !interp.error.has_error;
+    interpreter_free(&interp);
+    return ok;
+}
+
+// Escreve as métricas de uma fase em JSON
+static void print_phase(const char* name, long iterations, double seconds, long ops_per_iter,
+                        const char* ops_name, size_t bytes_per_iter) {
+    double ops = (double)ops_per_iter * iterations;
+    printf("      \"%s\": {\"iterations\": %ld, \"seconds\": %.6f, \"%s_per_sec\": %.1f, "
+           "\"ns_per_op\": %.3f, \"mb_per_sec\": %.3f}",
+           name, iterations, seconds, ops_name, ops / seconds,
+           seconds * 1e9 / ops, (double)bytes_per_iter * iterations / seconds / 1e6);
+}
+
+// Executa uma carga e imprime o seu objeto JSON (roda em processo filho)
+static void run_workload(const Workload* workload, int scale) {
+    Buffer source = { NULL, 0, 0 };
+    workload->generate(&source, scale);
+
+    long tokens = 0;
+    long iterations = 0;
+    double start = now_seconds();
+    double elapsed;
+    do {
+        tokens = run_lex(source.data);
+        iterations++;
+        elapsed = now_seconds() - start;
+    } while (elapsed < BENCH_MIN_TIME);
+    long lex_iterations = iterations;
+    double lex_seconds = elapsed;
+
+    long nodes = 0;
+    iterations = 0;
+    start = now_seconds();
+    do {
+        ASTNode* ast = run_parse(source.data);
+        nodes = count_nodes(ast);
+        free_ast(&allocator, ast);
+        iterations++;
+        elapsed = now_seconds() - start;
+    } while (elapsed < BENCH_MIN_TIME);
+    long parse_iterations = iterations;
+    double parse_seconds = elapsed;
+
+    printf("    {\n      \"name\": \"%s\",\n      \"source_bytes\": %zu,\n      \"tokens\": %ld,\n      \"nodes\": %ld,\n",
+           workload->name, source.length, tokens, nodes);
+    print_phase("lex", lex_iterations, lex_seconds, tokens, "tokens", source.length);
+    printf(",\n");
+    print_phase("parse", parse_iterations, parse_seconds, nodes, "nodes", source.length);
+    printf(",\n");
+
+    if (workload->executable) {
+        ASTNode* ast = run_parse(source.data);
+        iterations = 0;
+        double seconds = 0.0;
+        do {
+            start = now_seconds();
+            if (!run_execute(ast)) {
+                fprintf(stderr, "Erro: falha ao executar a carga %s.\n", workload->name);
+                exit(1);
+            }
+            seconds += now_seconds() - start;
+            iterations++;
+        } while (seconds < BENCH_MIN_TIME);
+        free_ast(&allocator, ast);
+        print_phase("execute", iterations, seconds, nodes, "nodes", source.length);
+    } else {
+        printf("      \"execute\": null");
+    }
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    printf(",\n      \"peak_rss_kb\": %ld\n    }", usage.ru_maxrss);
+    free(source.data);
+}
+
+int main(int argc, char* argv[]) {
+    int scale = 1;
+    const char* only = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--scale=", 8) == 0) {
+            scale = atoi(argv[i] + 8);
+        } else if (strncmp(argv[i], "--only=", 7) == 0) {
+            only = argv[i] + 7;
+        } else {
+            fprintf(stderr, "Uso: %s [--scale=N] [--only=carga]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (scale < 1) {
+        scale = 1;
+    }
+    allocator_init(&allocator, ALLOC_SYSTEM);
+    null_fd = open("/dev/null", O_WRONLY);
+
+    printf("{\n  \"version\": \"%s\",\n  \"timestamp\": %ld,\n  \"scale\": %d,\n  \"workloads\": [\n",
+           RODY_BENCH_VERSION, (long)time(NULL), scale);
+
+    int first = 1;
+    for (size_t i = 0; i < sizeof(workloads) / sizeof(workloads[0]); i++) {
+        if (only != NULL && strcmp(only, workloads[i].name) != 0) {
+            continue;
+        }
+        if (!first) {
+            printf(",\n");
+        }
+        first = 0;
+        fflush(stdout);
+
+        // Cada carga roda em um processo filho para que o pico de RSS seja só dela
+        pid_t pid = fork();
+        if (pid == 0) {
+            run_workload(&workloads[i], scale);
+            fflush(stdout);
+            _exit(0);
+        }
+        int status = 0;
+        if (pid < 0 || waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            fprintf(stderr, "Erro: a carga %s falhou.\n", workloads[i].name);
+            return 1;
+        }
+    }
+
+    printf("\n  ]\n}\n");
+    return 0;
+}
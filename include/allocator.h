@@ -0,0 +1,83 @@
+
+/* allocator.h */
+
+#ifndef ALLOCATOR_H
+#define ALLOCATOR_H
+
+#include <stddef.h>
+
+// Subsistema responsável por cada alocação (para as estatísticas)
+typedef enum {
+    MEM_LEXER,
+    MEM_PARSER,
+    MEM_INTERPRETER,
+    MEM_SYMBOLS,
+    MEM_OUTPUT,
+    MEM_INPUT,
+    // Quantidade de subsistemas (manter por último)
+    MEM_TAG_COUNT,
+} MemTag;
+
+// Backends de alocação selecionáveis na criação da instância
+typedef enum {
+    ALLOC_SYSTEM, // malloc/realloc/free do sistema
+    ALLOC_ARENA,  // Blocos grandes; free não devolve memória até o fim
+    ALLOC_DEBUG,  // Sistema + padrões de preenchimento e canários
+} AllocatorBackend;
+
+// Contadores por subsistema
+typedef struct {
+    long long allocs;
+    long long frees;
+    long long reallocs;
+    long long bytes;         // Em uso
+    long long peak_bytes;    // Maior valor de bytes
+    long long total_bytes;   // Total já alocado
+    long long realloc_moved; // Bytes copiados por realloc que mudou o bloco de lugar
+} MemStats;
+
+typedef struct ArenaBlock ArenaBlock;
+
+// Alocador com contabilidade por subsistema (um por instância)
+typedef struct {
+    AllocatorBackend backend;
+    MemStats stats[MEM_TAG_COUNT];
+    long long bytes;      // Em uso, todos os subsistemas
+    long long peak_bytes; // Pico de todos os subsistemas
+    ArenaBlock* arena;    // Blocos do backend arena
+    long long corruptions; // Canários ou cabeçalhos inválidos vistos pelo backend debug
+} Allocator;
+
+// Função para inicializar o alocador com o backend escolhido
+void allocator_init(Allocator* allocator, AllocatorBackend backend);
+
+// Função para liberar a memória própria do alocador (blocos da arena)
+void allocator_free(Allocator* allocator);
+
+// Função para converter o nome de um backend ("system", "arena", "debug")
+// Retorna 0 se o nome for desconhecido
+int allocator_backend_from_name(const char* name, AllocatorBackend* backend);
+
+// Função para obter o nome de um backend
+const char* allocator_backend_name(AllocatorBackend backend);
+
+// Funções de alocação; o subsistema é registrado no cabeçalho do bloco
+void* mem_alloc(Allocator* allocator, MemTag tag, size_t size);
+void* mem_realloc(Allocator* allocator, MemTag tag, void* ptr, size_t size);
+void mem_free(Allocator* allocator, void* ptr);
+char* mem_strndup(Allocator* allocator, MemTag tag, const char* s, size_t length);
+
+// Função para somar os contadores de um alocador aos de outro, usado só para
+// estatísticas. Os picos também são somados: um limite superior do pico conjunto.
+void mem_stats_merge(Allocator* into, const Allocator* from);
+
+// Função para escrever as estatísticas em um descritor de arquivo.
+// Não aloca nem usa stdio, podendo ser chamada de um tratador de sinal.
+void mem_stats_write(const Allocator* allocator, int fd);
+
+// Função para escrever as estatísticas de um alocador somadas às de outro
+// (NULL para nenhum), com as mesmas garantias de mem_stats_write
+void mem_stats_write_merged(const Allocator* allocator, const Allocator* extra, int fd);
+
+#endif // ALLOCATOR_H
+
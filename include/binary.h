@@ -0,0 +1,70 @@
+
+/* binary.h */
+
+#ifndef BINARY_H
+#define BINARY_H
+
+#include <stdint.h>
+#include "interpreter.h"
+
+// Identificação e versão do formato binário de valores
+#define BINARY_MAGIC "RODYBIN"
+#define BINARY_VERSION 1
+
+// Alinhamento dos vetores tipados (arrays crus de int/float) no arquivo
+#define BINARY_ARRAY_ALIGN 64
+
+// Arquivo carregado com mmap. Listas e dicionários de dentro dele apontam
+// para esta estrutura, que fica no próprio cabeçalho do arquivo mapeado:
+// copiar ou soltar qualquer um deles mexe só nesta contagem.
+typedef struct MappedImage {
+    int refs;
+    void* base;
+    size_t size;
+} MappedImage;
+
+// Cabeçalho do arquivo. O corpo guarda as estruturas exatamente como ficam
+// na memória (Value, List, Dict com a tabela hash já montada), com os
+// ponteiros gravados como deslocamentos a partir do início do arquivo. A
+// tabela de relocações lista cada um desses ponteiros; carregar é um mmap
+// privado seguido de somar o endereço base em cada relocação.
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;   // 0x01020304 na ordem de bytes de quem gravou
+    uint32_t value_size;   // sizeof(Value) de quem gravou
+    uint32_t pointer_size; // sizeof(void*) de quem gravou
+    uint64_t file_size;
+    uint64_t root;         // Deslocamento do Value raiz
+    uint64_t relocs;       // Deslocamento da tabela de relocações (uint64_t cada)
+    uint64_t num_relocs;
+    MappedImage image;     // Zerado no arquivo; preenchido na carga
+} BinaryHeader;
+
+// Resultado de save/load
+typedef enum {
+    BINARY_OK = 0,
+    BINARY_IO_ERROR,
+    BINARY_BAD_FORMAT,
+    BINARY_UNSUPPORTED, // Outra versão do formato ou outra arquitetura
+    BINARY_NO_MEMORY,
+} BinaryStatus;
+
+// Função para gravar um valor (e tudo o que ele contém) em um arquivo.
+// Listas só de int ou só de float são gravadas como vetores tipados.
+BinaryStatus binary_save(Allocator* allocator, Value value, const char* path);
+
+// Função para carregar um valor gravado por binary_save. Listas e
+// dicionários são usados direto do arquivo mapeado; strings e números na
+// raiz são copiados e o arquivo é desmapeado. Depois das relocações o grafo
+// inteiro é verificado (tipos, limites, ponteiros, strings e tabelas hash):
+// qualquer inconsistência devolve BINARY_BAD_FORMAT.
+BinaryStatus binary_load(Allocator* allocator, const char* path, Value* value);
+
+// Função para obter a descrição de um resultado
+const char* binary_status_message(BinaryStatus status);
+
+// Função para soltar uma referência ao arquivo mapeado (desmapeia na última)
+void image_release(MappedImage* image);
+
+#endif // BINARY_H
@@ -0,0 +1,48 @@
+
+/* dict.h */
+
+#ifndef DICT_H
+#define DICT_H
+
+#include "interpreter.h"
+
+struct MappedImage;
+
+// Entrada da tabela hash (key NULL = posição vazia)
+typedef struct {
+    char* key;
+    unsigned int hash;
+    Value value;
+} DictEntry;
+
+// Dicionário com chaves string: endereçamento aberto com sondagem linear e
+// capacidade potência de 2. A mesma tabela é gravada nos arquivos binários,
+// que já trazem o índice pronto.
+typedef struct {
+    int refs;
+    int count;
+    int capacity;
+    DictEntry* entries;
+    struct MappedImage* image; // Arquivo mapeado que contém o dicionário, ou NULL
+} Dict;
+
+// Função para calcular o hash de uma chave (FNV-1a; estável entre execuções)
+unsigned int dict_hash(const char* key);
+
+// Função para criar um dicionário vazio (NULL se faltar memória)
+Dict* dict_new(Allocator* allocator);
+
+// Função para associar um valor a uma chave (o dicionário passa a ser dono
+// do valor; a chave é copiada). Retorna 0 se faltar memória.
+int dict_set(Allocator* allocator, Dict* dict, const char* key, Value value);
+
+// Função para buscar uma chave; NULL se ausente (o valor continua do dicionário)
+const Value* dict_get(const Dict* dict, const char* key);
+
+// Função para tomar mais uma referência
+void dict_retain(Dict* dict);
+
+// Função para soltar uma referência; o dicionário é liberado na última
+void dict_release(Allocator* allocator, Dict* dict);
+
+#endif // DICT_H
@@ -0,0 +1,30 @@
+
+/* error.h */
+
+#ifndef ERROR_H
+#define ERROR_H
+
+#include <stdarg.h>
+
+// Tamanho máximo da mensagem de erro
+#define RODY_ERROR_MAX 256
+
+// Estrutura para reportar erros sem encerrar o processo
+typedef struct {
+    int has_error;
+    int line;
+    int column;
+    char message[RODY_ERROR_MAX];
+} RodyError;
+
+// Função para inicializar (limpar) um erro
+void error_init(RodyError* error);
+
+// Função para registrar um erro; apenas o primeiro erro é mantido
+void error_set(RodyError* error, int line, int column, const char* format, ...);
+
+// Versão de error_set que recebe uma va_list
+void error_vset(RodyError* error, int line, int column, const char* format, va_list args);
+
+#endif // ERROR_H
+
@@ -0,0 +1,47 @@
+
+/* input.h */
+
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <stddef.h>
+#include "allocator.h"
+#include "output.h"
+
+// Tamanho inicial do buffer de entrada (cresce para linhas maiores)
+#define INPUT_BUFFER_SIZE (64 * 1024)
+
+// Buffer de leitura do get: um read() grande é dividido em linhas com memchr
+typedef struct {
+    int fd;
+    char* data; // Alocado no primeiro uso
+    size_t start;    // Início dos dados ainda não consumidos
+    size_t end;      // Fim dos dados lidos
+    size_t scanned;  // Até onde já se procurou por '\n' a partir de start
+    size_t capacity;
+    int eof;
+    Allocator* allocator;
+    OutputBuffer* output; // Descarregado antes de cada read() que pode bloquear
+} InputBuffer;
+
+// Função para inicializar o buffer de entrada para um descritor
+void input_init(InputBuffer* in, int fd, Allocator* allocator, OutputBuffer* output);
+
+// Função para liberar o buffer de entrada
+void input_free(InputBuffer* in);
+
+// Função para trocar o descritor de origem (descarta dados pendentes)
+void input_set_fd(InputBuffer* in, int fd);
+
+// Função para ler a próxima linha sem copiá-la. A fatia aponta para dentro
+// do buffer, termina em '\0' (o '\n' e um '\r' final são removidos) e só é
+// válida até a próxima leitura. Retorna 0 no fim da entrada.
+int input_next_line(InputBuffer* in, const char** line, size_t* length);
+
+// Função para ler até max_lines linhas (ou toda a entrada restante, se
+// max_lines <= 0) para uma única string alocada com MEM_INPUT.
+// Retorna NULL se a entrada já tinha acabado ou se faltar memória.
+char* input_read_lines(InputBuffer* in, long max_lines, size_t* length);
+
+#endif // INPUT_H
+
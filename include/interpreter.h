@@ -4,6 +4,14 @@
 #define INTERPRETER_H
 
 #include "rody.h"
+#include "error.h"
+#include "allocator.h"
+#include "profiler.h"
+#include "sampler.h"
+#include "output.h"
+#include "input.h"
+#include "modules.h"
+#include "tracer.h"
 
 // Estrutura para representar um valor no interpretador
 typedef enum {
@@ -21,9 +29,8 @@ typedef struct {
         int int_val;
         float float_val;
         char* string_val;
-        // Ponteiros para estruturas de lista e dicionário (ainda não implementadas)
-        void* list_val;
-        void* dict_val;
+        void* list_val; // List* (iterator.h)
+        void* dict_val; // Dict* (dict.h)
     } data;
 } Value;
 
@@ -36,13 +43,56 @@ typedef struct SymbolTableEntry {
 
 typedef struct {
     SymbolTableEntry* head;
+    Allocator* allocator; // Alocador das entradas e dos valores
 } SymbolTable;
 
+// Limites das chamadas de função
+#define RODY_MAX_PARAMS 16
+#define RODY_MAX_CALL_DEPTH 1000
+
+struct MemoCache;
+
+// Função declarada com fun
+typedef struct {
+    const char* name;       // Nome (pertence ao token da declaração)
+    ASTNode* decl;          // NODE_FUN_DECL: parâmetros e, por último, o corpo
+    int num_params;
+    int pure;               // Sem efeitos colaterais: o resultado só depende dos argumentos
+    struct MemoCache* memo; // Resultados já calculados, ou NULL
+    const char* file;       // Módulo da declaração, ou NULL no programa principal
+} Function;
+
+// Estado de uma instância do interpretador (sem variáveis globais ocultas)
+typedef struct {
+    Allocator* allocator;
+    SymbolTable globals;
+    SymbolTable* locals; // Variáveis da chamada em andamento, ou NULL fora de funções
+    SymbolTable stage_vars; // Parâmetros dos estágios map/filter em avaliação (entradas da passada)
+    Function* functions; // As declarações precisam viver tanto quanto o interpretador
+    int num_functions;
+    int function_capacity;
+    int declarations; // Declarações fun já executadas, redefinições incluídas
+    int memo_size; // Limite do cache de cada função pura (0 desliga a memoização)
+    int call_depth;
+    const char* file; // Módulo do código em execução, ou NULL no programa principal
+    int returning; // Um return está encerrando a chamada em andamento
+    Value return_value;
+    RodyError error; // Primeiro erro de execução encontrado
+    int import_failed; // O erro veio de um módulo que não pôde ser lido ou analisado
+    OutputBuffer output; // Saída do print
+    InputBuffer input; // Entrada do get
+    ModuleTable* modules; // Módulos carregados pelo import, ou NULL
+    Profiler* profiler; // NULL quando o perfil está desligado
+    ShadowStack* shadow; // Pilha-sombra para o sampler, ou NULL
+    TraceRing* trace; // Anel de eventos da thread que executa, ou NULL
+} Interpreter;
+
 // Função para inicializar a tabela de símbolos
-void init_symbol_table(SymbolTable* table);
+void init_symbol_table(SymbolTable* table, Allocator* allocator);
 
 // Função para adicionar um símbolo à tabela
-void add_symbol(SymbolTable* table, const char* name, Value value);
+// Retorna 0 se não houver memória para a nova entrada
+int add_symbol(SymbolTable* table, const char* name, Value value);
 
 // Função para buscar um símbolo na tabela
 Value* get_symbol(SymbolTable* table, const char* name);
@@ -50,11 +100,22 @@ Value* get_symbol(SymbolTable* table, const char* name);
 // Função para liberar a tabela de símbolos
 void free_symbol_table(SymbolTable* table);
 
+// Função para inicializar o interpretador
+void interpreter_init(Interpreter* interp, Allocator* allocator);
+
+// Função para liberar o estado do interpretador
+void interpreter_free(Interpreter* interp);
+
 // Função para interpretar a AST
-Value interpret(ASTNode* node, SymbolTable* global_table);
+// Em caso de erro retorna VALUE_NULL e preenche interp->error
+Value interpret(Interpreter* interp, ASTNode* node);
 
 // Função para liberar um valor
-void free_value(Value value);
+void free_value(Allocator* allocator, Value value);
+
+// Função para copiar um valor (strings são duplicadas; listas são compartilhadas)
+// Retorna 0 se faltar memória
+int copy_value(Allocator* allocator, Value value, Value* copy);
 
 #endif // INTERPRETER_H
 
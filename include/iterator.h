@@ -0,0 +1,76 @@
+
+/* iterator.h */
+
+#ifndef ITERATOR_H
+#define ITERATOR_H
+
+#include "interpreter.h"
+
+struct MappedImage;
+
+// Representação dos itens de uma lista
+typedef enum {
+    LIST_VALUES, // Array de Value (toda lista criada pelo interpretador)
+    LIST_INTS,   // Array cru de int (vetores tipados carregados de arquivo)
+    LIST_FLOATS, // Array cru de float
+} ListKind;
+
+// Lista (vetor) de valores, compartilhada por contagem de referências:
+// copiar um valor VALUE_LIST só incrementa refs
+typedef struct {
+    int refs;
+    ListKind kind;
+    int count;
+    int capacity;
+    Value* items;              // LIST_VALUES
+    void* raw;                 // LIST_INTS e LIST_FLOATS
+    struct MappedImage* image; // Arquivo mapeado que contém a lista, ou NULL
+} List;
+
+// Função para criar uma lista vazia (NULL se faltar memória)
+List* list_new(Allocator* allocator, int capacity);
+
+// Função para adicionar um valor ao fim da lista (a lista passa a ser dona dele)
+// Retorna 0 se faltar memória
+int list_append(Allocator* allocator, List* list, Value value);
+
+// Função para tomar mais uma referência
+void list_retain(List* list);
+
+// Função para soltar uma referência; a lista é liberada na última
+void list_release(Allocator* allocator, List* list);
+
+// Função para ler o item index sem copiá-lo (strings e listas continuam
+// pertencendo à lista)
+Value list_get(const List* list, int index);
+
+// Tipos de fonte de um iterador
+typedef enum {
+    ITER_RANGE, // Contador: memória O(1), nenhum valor é alocado
+    ITER_LIST,  // Percorre os itens de uma lista existente
+} IteratorKind;
+
+// Iterador preguiçoso: produz um elemento por vez, sob demanda
+typedef struct {
+    IteratorKind kind;
+    long long current;
+    long long end;
+    List* list;      // Referência mantida enquanto o iterador existe
+    Allocator* allocator;
+    int failed;      // Falta de memória ao copiar um elemento
+} Iterator;
+
+// Função para iniciar um iterador sobre o intervalo [start, end)
+void iterator_range(Iterator* it, long long start, long long end);
+
+// Função para iniciar um iterador sobre uma lista (toma uma referência)
+void iterator_list(Iterator* it, Allocator* allocator, List* list);
+
+// Função para obter o próximo elemento; retorna 0 no fim.
+// O elemento pertence ao chamador (strings são copiadas).
+int iterator_next(Iterator* it, Value* element);
+
+// Função para liberar o iterador
+void iterator_close(Iterator* it);
+
+#endif // ITERATOR_H
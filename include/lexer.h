@@ -4,6 +4,7 @@
 #define LEXER_H
 
 #include "rody.h"
+#include "allocator.h"
 
 // Estrutura para o lexer
 typedef struct {
@@ -11,19 +12,20 @@ typedef struct {
     int current_pos;
     int line;
     int column;
+    Allocator* allocator; // Alocador dos lexemes
 } Lexer;
 
 // Função para inicializar o lexer
-void lexer_init(Lexer* lexer, const char* source);
+void lexer_init(Lexer* lexer, const char* source, Allocator* allocator);
 
 // Função para obter o próximo token
 Token lexer_next_token(Lexer* lexer);
 
 // Função para liberar a memória de um token
-void token_free(Token* token);
+void token_free(Allocator* allocator, Token* token);
 
 // Função auxiliar para criar um token (declarada aqui para uso em parser.c)
-Token make_token(TokenType type, const char* start, int length, int line, int column);
+Token make_token(Allocator* allocator, TokenType type, const char* start, int length, int line, int column);
 
 #endif // LEXER_H
 
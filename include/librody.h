@@ -0,0 +1,94 @@
+
+/* librody.h */
+
+#ifndef LIBRODY_H
+#define LIBRODY_H
+
+#include "interpreter.h"
+#include "tracer.h"
+
+// Contexto opaco de uma instância (isolate) do interpretador.
+// Cada RodyVM guarda todo o seu estado; instâncias diferentes podem ser
+// usadas ao mesmo tempo em threads diferentes, mas uma mesma instância
+// não deve ser usada por duas threads simultaneamente.
+typedef struct RodyVM RodyVM;
+
+// Códigos de retorno da biblioteca
+typedef enum {
+    RODY_OK = 0,
+    RODY_ERROR_SYNTAX,
+    RODY_ERROR_RUNTIME,
+    RODY_ERROR_IMPORT, // Import circular, ou um import executado de módulo que não pôde ser lido ou analisado
+} RodyStatus;
+
+// Função para criar uma nova instância (retorna NULL se faltar memória)
+RodyVM* rody_vm_new(void);
+
+// Função para criar uma instância com um backend de alocação específico
+RodyVM* rody_vm_new_with_backend(AllocatorBackend backend);
+
+// Função para liberar uma instância e todo o seu estado
+void rody_vm_free(RodyVM* vm);
+
+// Função para avaliar um código fonte na instância.
+// As variáveis globais persistem entre avaliações da mesma instância.
+// Se result não for NULL, recebe o valor da última instrução, que deve
+// ser liberado com rody_value_free.
+RodyStatus rody_vm_eval(RodyVM* vm, const char* source, Value* result);
+
+// Função para redirecionar a saída do print para outro descritor.
+// Com line_buffered a saída é descarregada a cada quebra de linha; sem ele,
+// só quando o buffer enche e ao fim de cada avaliação.
+void rody_vm_set_output(RodyVM* vm, int fd, int line_buffered);
+
+// Função para trocar o descritor lido pelo get (padrão: entrada padrão).
+// Dados já lidos do descritor anterior e ainda não consumidos são descartados.
+void rody_vm_set_input(RodyVM* vm, int fd);
+
+// Função para definir o diretório onde os imports são procurados (padrão: ".")
+void rody_vm_set_import_path(RodyVM* vm, const char* dir);
+
+// Função para definir quantas threads analisam os imports (0 = número de
+// núcleos; 1 = analisa tudo na thread que chamou rody_vm_eval)
+void rody_vm_set_import_threads(RodyVM* vm, int threads);
+
+// Função para definir quantos resultados cada função pura guarda no cache
+// de memoização (padrão: MEMO_DEFAULT_SIZE; 0 desliga). Vale para as funções
+// declaradas depois da chamada.
+void rody_vm_set_memo_size(RodyVM* vm, int entries);
+
+// Funções para consultar os módulos carregados pela instância e o erro de
+// cada um (NULL se o módulo foi carregado sem erro). Um módulo com erro só
+// interrompe a avaliação quando o import dele executa; em RODY_ERROR_IMPORT,
+// rody_vm_error traz esse erro (ou o do primeiro ciclo, em ordem de dependência).
+int rody_vm_module_count(const RodyVM* vm);
+const char* rody_vm_module_error(const RodyVM* vm, int index);
+
+// Função para liberar um valor devolvido por rody_vm_eval
+void rody_value_free(RodyVM* vm, Value value);
+
+// Função para obter o alocador da instância (estatísticas de memória)
+const Allocator* rody_vm_allocator(const RodyVM* vm);
+
+// Função para obter a soma dos contadores dos alocadores próprios de cada
+// módulo importado (tokens e AST analisados pelas threads de import). Só
+// estatísticas: nada é alocado por ele. Some ao relatório com mem_stats_write_merged.
+const Allocator* rody_vm_modules_allocator(const RodyVM* vm);
+
+// Função para ligar (ou desligar, com NULL) o profiler por instrumentação.
+// O profiler pertence ao chamador e acumula dados entre avaliações.
+void rody_vm_set_profiler(RodyVM* vm, Profiler* profiler);
+
+// Função para ligar (ou desligar, com NULL) a pilha-sombra lida pelo sampler.
+// O sampler pertence ao chamador; só um pode estar ativo por processo.
+void rody_vm_set_sampler(RodyVM* vm, Sampler* sampler);
+
+// Função para ligar (ou desligar, com NULL) o registro de eventos.
+// Um mesmo Tracer pode ser compartilhado por instâncias em threads diferentes.
+void rody_vm_set_tracer(RodyVM* vm, Tracer* tracer);
+
+// Função para obter a mensagem do último erro da instância
+const char* rody_vm_error(const RodyVM* vm);
+
+#endif // LIBRODY_H
+
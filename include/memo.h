@@ -0,0 +1,62 @@
+
+/* memo.h */
+
+#ifndef MEMO_H
+#define MEMO_H
+
+#include "interpreter.h"
+
+// Quantidade padrão de resultados guardados por função pura
+#define MEMO_DEFAULT_SIZE 4096
+
+// Resultado guardado para uma combinação de argumentos
+typedef struct {
+    unsigned int hash;
+    Value* args;   // Cópias dos argumentos (fatia de MemoCache.args)
+    Value result;
+    int prev;      // Vizinhos na lista LRU (-1 nas pontas)
+    int next;
+    int chain;     // Próxima entrada do mesmo balde (-1 no fim)
+} MemoEntry;
+
+// Cache de resultados de uma função pura: tabela hash encadeada por índices
+// mais uma lista LRU. Cheio, descarta o resultado usado há mais tempo.
+typedef struct MemoCache {
+    Allocator* allocator;
+    int capacity;       // Limite de entradas
+    int num_args;       // Aridade da função (igual para todas as entradas)
+    int count;
+    MemoEntry* entries; // Reservadas na primeira inserção
+    Value* args;        // capacity * num_args argumentos, numa só alocação
+    int* buckets;       // -1 = balde vazio
+    int num_buckets;    // Potência de 2
+    int head;           // Usada mais recentemente
+    int tail;           // Próxima a ser descartada
+    MemoStats stats;
+} MemoCache;
+
+// Função para inicializar um cache vazio (nada é alocado até a primeira inserção)
+void memo_init(MemoCache* cache, Allocator* allocator, int capacity, int num_args);
+
+// Função para liberar o cache e os valores guardados
+void memo_free(MemoCache* cache);
+
+// Função para esvaziar o cache (a função foi redefinida). Os contadores são
+// mantidos; num_args passa a ser a aridade da nova definição.
+void memo_clear(MemoCache* cache, int num_args);
+
+// Função para verificar se os argumentos podem ser chave (int, float, string ou null)
+int memo_can_key(const Value* args, int num_args);
+
+// Função para calcular o hash dos argumentos
+unsigned int memo_hash(const Value* args, int num_args);
+
+// Função para buscar um resultado; NULL se ausente. Conta acerto ou falta e
+// marca a entrada como a mais recente. O valor continua pertencendo ao cache.
+const Value* memo_lookup(MemoCache* cache, const Value* args, unsigned int hash);
+
+// Função para guardar uma cópia do resultado (e dos argumentos)
+// Retorna 0 se faltar memória; o cache continua válido
+int memo_store(MemoCache* cache, const Value* args, unsigned int hash, Value result);
+
+#endif // MEMO_H
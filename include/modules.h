@@ -0,0 +1,94 @@
+
+/* modules.h */
+
+#ifndef MODULES_H
+#define MODULES_H
+
+#include <pthread.h>
+#include "rody.h"
+#include "error.h"
+#include "allocator.h"
+#include "tracer.h"
+
+// Tamanho máximo do caminho de um módulo
+#define MODULE_PATH_MAX 1024
+
+// Limite de threads de análise de imports
+#define MODULE_THREADS_MAX 64
+
+// Módulo importado. Cada módulo tem alocador próprio, para que o lexer e o
+// parser de módulos diferentes rodem em threads diferentes sem travas.
+typedef struct {
+    char path[MODULE_PATH_MAX];
+    Allocator allocator; // Tokens e AST do módulo
+    ASTNode* ast;        // NULL se a leitura ou a análise falhou
+    RodyError error;     // Erro do módulo, já com o caminho na mensagem
+    int* imports;        // Índices dos módulos importados (da pré-varredura)
+    int num_imports;
+    int link_state;      // Marca da ordenação por dependência (0, 1 = visitando, 2 = pronto)
+    int circular;        // Faz parte de um ciclo de imports (rejeitado antes da execução)
+    int executed;        // Já executado nesta instância
+} Module;
+
+// Tabela de módulos de uma instância e fila de análise paralela
+typedef struct {
+    Module** modules;    // Ponteiros estáveis: a tabela cresce enquanto as threads trabalham
+    int count;
+    int capacity;
+    int* roots;          // Módulos importados pelo fonte principal da avaliação atual
+    int num_roots;
+    char search_dir[MODULE_PATH_MAX];
+    AllocatorBackend backend;
+    Allocator stats;     // Só contadores: a soma dos alocadores dos módulos, após cada análise
+    int threads;         // Threads de análise (0 = número de núcleos)
+    Tracer* tracer;      // NULL quando o registro de eventos está desligado
+    // Fila: módulos a partir de next_job ainda não foram analisados
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    int next_job;
+    int active;
+    pthread_t workers[MODULE_THREADS_MAX];
+    int num_workers;
+    int worker_limit;    // Threads que ainda podem ser criadas (0 fora de modules_begin/wait)
+} ModuleTable;
+
+// Função para inicializar a tabela de módulos
+void modules_init(ModuleTable* table, AllocatorBackend backend);
+
+// Função para liberar todos os módulos
+void modules_free(ModuleTable* table);
+
+// Função para definir o diretório onde os imports são procurados
+void modules_set_search_dir(ModuleTable* table, const char* dir);
+
+// Função para montar o caminho de um import feito por código do diretório
+// dir: `import nome;` procura nome.ry em dir e `import "arquivo";` usa o
+// caminho dado, relativo a dir se não for absoluto. Segmentos "." e ".." são
+// simplificados. Retorna 0 se o caminho não couber em size.
+int module_resolve(const char* dir, TokenType kind, const char* name, char* path, size_t size);
+
+// Função para obter o diretório de um módulo, onde os imports dele são procurados
+void module_dir(const char* path, char* dir, size_t size);
+
+// Função para iniciar a carga dos imports de um fonte: uma pré-varredura
+// encontra os imports e cada módulo é lido, tokenizado e analisado por um
+// conjunto de threads, que também seguem os imports dos próprios módulos.
+// O chamador pode analisar o fonte principal enquanto isso.
+void modules_begin(ModuleTable* table, const char* source);
+
+// Função para esperar a análise de todos os módulos descobertos
+void modules_wait(ModuleTable* table);
+
+// Função para verificar os módulos importados pela avaliação atual em ordem
+// de dependência (dependências antes de quem as importa), detectando ciclos.
+// Retorna 0 se houver um ciclo; error recebe o primeiro. Erros de leitura e
+// análise ficam em cada módulo e só são levantados quando o import executa.
+int modules_link(ModuleTable* table, RodyError* error);
+
+// Função para obter um módulo já carregado, ou carregá-lo agora (sem
+// threads) se a pré-varredura não o encontrou. importer é o caminho do módulo
+// que faz o import (NULL no fonte principal, que usa o diretório de busca).
+// Retorna NULL se faltar memória ou se o caminho não couber.
+Module* modules_get(ModuleTable* table, const char* importer, TokenType kind, const char* name);
+
+#endif // MODULES_H
@@ -0,0 +1,52 @@
+
+/* output.h */
+
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <stddef.h>
+#include "allocator.h"
+
+// Tamanho do buffer de saída de cada instância
+#define OUTPUT_BUFFER_SIZE (64 * 1024)
+
+// Buffer de saída do print: só é descarregado quando enche, antes de ler
+// entrada, antes de chamadas ao sistema e ao fim da execução (ou a cada
+// quebra de linha no modo de linha)
+typedef struct {
+    int fd;
+    char* data; // Alocado no primeiro uso
+    size_t length;
+    int line_buffered;
+    int colors; // 0 quando o destino não é um terminal
+    int failed; // 1 após um erro de escrita
+    Allocator* allocator;
+} OutputBuffer;
+
+// Função para inicializar o buffer de saída para um descritor
+void output_init(OutputBuffer* out, int fd, Allocator* allocator);
+
+// Função para descarregar e liberar o buffer
+void output_free(OutputBuffer* out);
+
+// Função para trocar o descritor de destino (descarrega o anterior)
+void output_set_fd(OutputBuffer* out, int fd, int line_buffered);
+
+// Função para escrever o conteúdo pendente no descritor
+void output_flush(OutputBuffer* out);
+
+// Funções de escrita no buffer
+void output_write(OutputBuffer* out, const char* data, size_t length);
+void output_char(OutputBuffer* out, char c);
+void output_newline(OutputBuffer* out);
+void output_int(OutputBuffer* out, long long value);
+void output_float(OutputBuffer* out, double value);
+
+// Função para obter o índice de uma cor pelo nome; -1 se desconhecida
+int output_color_index(const char* name);
+
+// Função para escrever a sequência ANSI de uma cor (ignorada fora de terminais)
+void output_color(OutputBuffer* out, int color);
+
+#endif // OUTPUT_H
+
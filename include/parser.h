@@ -5,22 +5,29 @@
 
 #include "rody.h"
 #include "lexer.h"
+#include "error.h"
 
 // Estrutura para o parser
 typedef struct {
     Lexer* lexer;
+    Allocator* allocator; // Alocador dos nós (o mesmo do lexer)
     Token current_token;
     Token previous_token;
+    RodyError error; // Primeiro erro de sintaxe encontrado
 } Parser;
 
 // Função para inicializar o parser
 void parser_init(Parser* parser, Lexer* lexer);
 
 // Função para analisar o programa e construir a AST
+// Retorna NULL em caso de erro (detalhes em parser->error)
 ASTNode* parse(Parser* parser);
 
 // Função para liberar a memória da AST
-void free_ast(ASTNode* node);
+void free_ast(Allocator* allocator, ASTNode* node);
+
+// Função para obter o nome de um tipo de nó (para relatórios)
+const char* node_type_name(NodeType type);
 
 #endif // PARSER_H
 
@@ -0,0 +1,106 @@
+
+/* profiler.h */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdio.h>
+#include "rody.h"
+
+// Estatística acumulada de execução (tempo próprio, sem os filhos)
+typedef struct {
+    long long count;
+    long long self_ns;
+} ProfileStat;
+
+// Nó da árvore de chamadas: um por caminho distinto (tipo de nó, arquivo, linha)
+typedef struct ProfileFrame {
+    NodeType type;
+    int file; // Índice em Profiler.files, ou -1 no programa principal
+    int line;
+    ProfileStat stat;
+    struct ProfileFrame* parent;
+    struct ProfileFrame* first_child; // Filhos em lista, para percorrer
+    struct ProfileFrame* next_sibling;
+    struct ProfileFrame** children;   // Os mesmos filhos numa tabela hash, para buscar
+    int num_children;
+    int child_capacity;               // Potência de 2 (0 até o primeiro filho)
+} ProfileFrame;
+
+// Estatística de uma linha de um arquivo
+typedef struct {
+    int file; // Índice em Profiler.files, ou -1 no programa principal
+    int line; // -1 = vaga livre na tabela
+    ProfileStat stat;
+} ProfileLine;
+
+// Contadores de um cache de memoização (mantidos pelo próprio cache)
+typedef struct {
+    long long hits;
+    long long misses;
+    long long evictions;
+} MemoStats;
+
+// Cache de uma função pura, listado no relatório
+typedef struct {
+    const char* name;       // Nome da função (pertence à declaração)
+    const MemoStats* stats; // Deve durar até o relatório
+} ProfileMemo;
+
+// Ativação em andamento na pilha do profiler
+typedef struct {
+    ProfileFrame* frame;
+    int file;
+    long long start_ns;
+    long long child_ns;
+} ProfileActivation;
+
+// Estado do profiler por instrumentação
+typedef struct {
+    ProfileStat by_type[NODE_TYPE_COUNT];
+    ProfileLine* by_line; // Tabela hash por (arquivo, linha do token do nó)
+    int num_lines;
+    int line_capacity;    // Potência de 2
+    char** files;         // Módulos vistos (cópias dos caminhos)
+    int num_files;
+    int file_capacity;
+    int current_file;     // Arquivo do código em execução (-1 = programa principal)
+    ProfileFrame root;
+    ProfileActivation* stack;
+    int depth;
+    int stack_capacity;
+    int overflow; // Ativações que não couberam na pilha
+    long long dropped; // Ativações não registradas por falta de memória
+    ProfileMemo* memos;
+    int num_memos;
+    int memo_capacity;
+} Profiler;
+
+// Função para inicializar o profiler
+void profiler_init(Profiler* profiler);
+
+// Função para liberar a memória do profiler
+void profiler_free(Profiler* profiler);
+
+// Função para informar o arquivo do código que passa a executar (NULL volta
+// ao programa principal); as linhas seguintes são contadas nesse arquivo
+void profiler_set_file(Profiler* profiler, const char* file);
+
+// Função chamada ao entrar na avaliação de um nó
+void profiler_enter(Profiler* profiler, const ASTNode* node);
+
+// Função chamada ao sair da avaliação do nó mais recente
+void profiler_exit(Profiler* profiler);
+
+// Função para listar no relatório os acertos e faltas do cache de uma função
+void profiler_add_memo(Profiler* profiler, const char* name, const MemoStats* stats);
+
+// Função para imprimir o relatório de pontos quentes, ordenado por tempo
+void profiler_report(const Profiler* profiler, FILE* out);
+
+// Função para gravar as pilhas no formato "folded" (flamegraph.pl)
+// Retorna 0 se o arquivo não puder ser escrito
+int profiler_write_folded(const Profiler* profiler, const char* path);
+
+#endif // PROFILER_H
+
@@ -3,6 +3,13 @@
 #ifndef RODY_H
 #define RODY_H
 
+// Dica de desvio improvável para sondas que ficam desligadas por padrão
+#if defined(__GNUC__)
+#define RODY_UNLIKELY(x) __builtin_expect(!!(x), 0)
+#else
+#define RODY_UNLIKELY(x) (x)
+#endif
+
 // Enumeração para os tipos de tokens
 typedef enum {
     TOKEN_IDENTIFIER,
@@ -60,6 +67,13 @@ typedef enum {
     TOKEN_GT,
     TOKEN_LE,
     TOKEN_GE,
+    // Intervalo numérico (a..b)
+    TOKEN_RANGE,
+    // Gravação e leitura de valores em arquivo binário
+    TOKEN_SAVE,
+    TOKEN_LOAD,
+    // Erro léxico (o lexeme aponta para uma mensagem estática)
+    TOKEN_ERROR,
 } TokenType;
 
 // Estrutura para representar um token
@@ -99,14 +113,27 @@ typedef enum {
     NODE_BLOCK,
     NODE_WAIT,
     NODE_IMPORT,
+    NODE_PRINT_FORMAT, // br, tab ou color dentro de um print
+    NODE_RANGE,        // a..b (sem materializar a lista)
+    NODE_PIPELINE,     // Fonte seguida de estágios map/filter fundidos numa só passada
+    NODE_MAP,          // Estágio .map(x: expr)
+    NODE_FILTER,       // Estágio .filter(x: expr)
+    NODE_INDEX,        // Acesso por índice ou chave: valor[i]
+    // Quantidade de tipos de nós (manter por último)
+    NODE_TYPE_COUNT,
 } NodeType;
 
+// Atributos de um nó
+#define NODE_FLAG_PURE 1 // fun ... pure: memoizar mesmo sem a análise provar a pureza
+#define NODE_FLAG_GET_ALL 2 // get string x, *: lê toda a entrada restante (sem filho de quantidade)
+
 // Estrutura para representar um nó da AST
 typedef struct ASTNode {
     NodeType type;
     Token token; // Token associado ao nó (ex: identificador, operador)
     struct ASTNode** children; // Array de ponteiros para nós filhos
     int num_children;
+    int flags; // Atributos declarados no código (NODE_FLAG_*)
     // Outros campos específicos para cada tipo de nó (ex: valor para literais, nome para funções)
 } ASTNode;
 
@@ -0,0 +1,102 @@
+
+/* sampler.h */
+
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include <stdio.h>
+#include <signal.h>
+#include "rody.h"
+
+// Profundidade máxima registrada da pilha de execução do script
+#define SHADOW_STACK_MAX 128
+
+// Tamanho máximo do nome copiado para cada frame amostrado
+#define SAMPLER_NAME_MAX 24
+
+// Frame da pilha-sombra mantida pelo interpretador: uma chamada de função
+// (com o nome) ou uma instrução de nível superior do programa ou módulo
+typedef struct {
+    int type;
+    int line;
+    const char* name; // Nome da função chamada, ou NULL
+} ShadowFrame;
+
+// Pilha-sombra lida pelo tratador de SIGPROF.
+// Só é escrita pela thread do interpretador; o frame é preenchido antes de
+// depth ser incrementado, então o tratador sempre vê frames completos.
+typedef struct {
+    ShadowFrame frames[SHADOW_STACK_MAX];
+    volatile sig_atomic_t depth; // Pode passar de SHADOW_STACK_MAX; o excesso não é registrado
+} ShadowStack;
+
+// Frame já copiado para uma amostra
+typedef struct {
+    int type;
+    int line;
+    char name[SAMPLER_NAME_MAX];
+} SampleFrame;
+
+// Pilha distinta amostrada e quantas vezes ela foi vista
+typedef struct {
+    unsigned int hash;
+    int offset; // Índice do primeiro frame em Sampler.pool
+    int depth;
+    long long count;
+} SampleStack;
+
+// Estado do profiler por amostragem (um por processo, pois SIGPROF é global)
+typedef struct {
+    ShadowStack shadow;
+    int hz;
+    SampleFrame* pool; // Frames das pilhas distintas, pré-alocados
+    int pool_used;
+    int pool_capacity;
+    SampleStack* stacks; // Tabela hash com endereçamento aberto, pré-alocada
+    int stack_capacity;
+    int num_stacks;
+    volatile long long samples;
+    volatile long long dropped; // Amostras perdidas por falta de espaço
+} Sampler;
+
+// Entrada na avaliação de um nó (chamada pelo interpretador)
+static inline void shadow_push(ShadowStack* shadow, const ASTNode* node) {
+    sig_atomic_t depth = shadow->depth;
+    if (depth < SHADOW_STACK_MAX) {
+        shadow->frames[depth].type = node->type;
+        shadow->frames[depth].line = node->token.line;
+        shadow->frames[depth].name = node->type == NODE_FUN_CALL ? node->token.lexeme : NULL;
+    }
+    // Garante que o frame esteja escrito antes de ficar visível ao tratador
+    __atomic_signal_fence(__ATOMIC_SEQ_CST);
+    shadow->depth = depth + 1;
+}
+
+// Saída da avaliação do nó mais recente
+static inline void shadow_pop(ShadowStack* shadow) {
+    shadow->depth = shadow->depth - 1;
+}
+
+// Função para inicializar o sampler; toda a memória usada pelo tratador é
+// alocada aqui. Retorna 0 se faltar memória.
+int sampler_init(Sampler* sampler, int hz);
+
+// Função para liberar a memória do sampler
+void sampler_free(Sampler* sampler);
+
+// Função para instalar o tratador de SIGPROF e iniciar o temporizador
+// Retorna 0 em caso de falha (por exemplo, outro sampler já ativo)
+int sampler_start(Sampler* sampler);
+
+// Função para parar o temporizador e restaurar o tratador anterior
+void sampler_stop(Sampler* sampler);
+
+// Função para imprimir um resumo das amostras
+void sampler_report(const Sampler* sampler, FILE* out);
+
+// Função para gravar as pilhas amostradas no formato "folded"
+// Retorna 0 se o arquivo não puder ser escrito
+int sampler_write_folded(const Sampler* sampler, const char* path);
+
+#endif // SAMPLER_H
+
@@ -0,0 +1,61 @@
+
+/* tracer.h */
+
+#ifndef TRACER_H
+#define TRACER_H
+
+// Capacidade padrão do anel de eventos de cada thread
+#define TRACE_RING_EVENTS 16384
+
+// Tamanho máximo do detalhe copiado para cada evento
+#define TRACE_DETAIL_MAX 48
+
+// Intervalo de tempo ("complete event" do Chrome Trace Event Format)
+typedef struct {
+    const char* name;     // String estática
+    const char* category; // String estática
+    long long start_ns;
+    long long duration_ns;
+    char detail[TRACE_DETAIL_MAX]; // Argumento opcional (arquivo, função...)
+} TraceEvent;
+
+// Anel de eventos de uma thread. Só a thread dona escreve; quando o anel
+// enche, os eventos mais antigos são sobrescritos, sem nunca bloquear.
+typedef struct TraceRing {
+    struct TraceRing* next; // Próximo anel registrado no Tracer
+    int tid;
+    int capacity;
+    unsigned long long head; // Total de eventos já escritos
+    TraceEvent events[];
+} TraceRing;
+
+// Registro de eventos compartilhado por todas as threads e instâncias
+typedef struct {
+    TraceRing* rings; // Lista lock-free de anéis (inserção por CAS)
+    int ring_events;
+    long long origin_ns; // Instante zero dos timestamps
+} Tracer;
+
+// Função para inicializar o tracer (ring_events <= 0 usa o padrão)
+void tracer_init(Tracer* tracer, int ring_events);
+
+// Função para liberar os anéis do tracer
+void tracer_free(Tracer* tracer);
+
+// Função para obter (ou criar) o anel da thread atual; NULL se faltar memória
+TraceRing* tracer_thread_ring(Tracer* tracer);
+
+// Função para ler o relógio usado nos eventos, em nanossegundos
+long long trace_now(void);
+
+// Função para registrar um intervalo no anel (ring NULL é ignorado)
+void trace_span(TraceRing* ring, const char* name, const char* category,
+                long long start_ns, long long end_ns, const char* detail);
+
+// Função para gravar todos os anéis em JSON (Chrome Trace Event Format).
+// Deve ser chamada quando nenhuma thread estiver mais registrando eventos.
+// Retorna 0 se o arquivo não puder ser escrito.
+int tracer_write(const Tracer* tracer, const char* path);
+
+#endif // TRACER_H
+
@@ -0,0 +1,412 @@
+
+/* allocator.c */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <unistd.h>
+#include "allocator.h"
+
+// Tamanho padrão de um bloco da arena
+#define ARENA_BLOCK_SIZE (64 * 1024)
+
+// Valores de controle do cabeçalho e padrões do backend debug
+#define BLOCK_MAGIC 0x52445942u  // "RDYB"
+#define BLOCK_FREED 0xDEADB10Cu
+#define DEBUG_CANARY_SIZE 8
+#define DEBUG_FILL_NEW 0xCD
+#define DEBUG_FILL_FREED 0xDD
+#define DEBUG_FILL_CANARY 0xFD
+
+// Cabeçalho gravado antes de cada bloco entregue ao chamador
+typedef union {
+    struct {
+        size_t size;
+        unsigned int tag;
+        unsigned int magic;
+    } info;
+    max_align_t align;
+} BlockHeader;
+
+// Bloco de memória do backend arena
+struct ArenaBlock {
+    ArenaBlock* next;
+    size_t used;
+    size_t capacity;
+    max_align_t data[]; // Área de alocação, alinhada
+};
+
+static const char* const tag_names[MEM_TAG_COUNT] = {
+    [MEM_LEXER] = "lexer",
+    [MEM_PARSER] = "parser",
+    [MEM_INTERPRETER] = "interpretador",
+    [MEM_SYMBOLS] = "símbolos",
+    [MEM_OUTPUT] = "saída",
+    [MEM_INPUT] = "entrada",
+};
+
+// Função para inicializar o alocador com o backend escolhido
+void allocator_init(Allocator* allocator, AllocatorBackend backend) {
+    memset(allocator, 0, sizeof(Allocator));
+    allocator->backend = backend;
+}
+
+// Função para liberar a memória própria do alocador (blocos da arena)
+void allocator_free(Allocator* allocator) {
+    ArenaBlock* block = allocator->arena;
+    while (block != NULL) {
+        ArenaBlock* next = block->next;
+        free(block);
+        block = next;
+    }
+    allocator->arena = NULL;
+}
+
+// Função para converter o nome de um backend
+int allocator_backend_from_name(const char* name, AllocatorBackend* backend) {
+    if (strcmp(name, "system") == 0) {
+        *backend = ALLOC_SYSTEM;
+    } else if (strcmp(name, "arena") == 0) {
+        *backend = ALLOC_ARENA;
+    } else if (strcmp(name, "debug") == 0) {
+        *backend = ALLOC_DEBUG;
+    } else {
+        return 0;
+    }
+    return 1;
+}
+
+// Função para obter o nome de um backend
+const char* allocator_backend_name(AllocatorBackend backend) {
+    switch (backend) {
+        case ALLOC_SYSTEM: return "system";
+        case ALLOC_ARENA: return "arena";
+        case ALLOC_DEBUG: return "debug";
+    }
+    return "?";
+}
+
+// Função auxiliar para arredondar ao alinhamento máximo
+static size_t align_up(size_t size) {
+    size_t align = sizeof(max_align_t);
+    return (size + align - 1) & ~(align - 1);
+}
+
+// Backend arena: aloca no bloco atual ou abre um novo
+static void* arena_alloc(Allocator* allocator, size_t size) {
+    size = align_up(size);
+    ArenaBlock* block = allocator->arena;
+    if (block == NULL || block->capacity - block->used < size) {
+        size_t capacity = size > ARENA_BLOCK_SIZE ? size : ARENA_BLOCK_SIZE;
+        block = (ArenaBlock*)malloc(sizeof(ArenaBlock) + capacity);
+        if (block == NULL) {
+            return NULL;
+        }
+        block->used = 0;
+        block->capacity = capacity;
+        block->next = allocator->arena;
+        allocator->arena = block;
+    }
+    void* ptr = (char*)block->data + block->used;
+    block->used += size;
+    return ptr;
+}
+
+// Backend arena: cresce no lugar se o bloco for o último alocado
+static void* arena_realloc(Allocator* allocator, void* raw, size_t old_size, size_t new_size) {
+    ArenaBlock* block = allocator->arena;
+    size_t old_aligned = align_up(old_size);
+    size_t new_aligned = align_up(new_size);
+    if (block != NULL && (char*)raw + old_aligned == (char*)block->data + block->used &&
+        block->used - old_aligned + new_aligned <= block->capacity) {
+        block->used = block->used - old_aligned + new_aligned;
+        return raw;
+    }
+    void* fresh = arena_alloc(allocator, new_size);
+    if (fresh != NULL) {
+        memcpy(fresh, raw, old_size < new_size ? old_size : new_size);
+    }
+    return fresh;
+}
+
+// Função auxiliar para o tamanho bruto de um bloco (cabeçalho + dados + canário)
+static size_t raw_size(const Allocator* allocator, size_t size) {
+    size_t total = sizeof(BlockHeader) + size;
+    if (allocator->backend == ALLOC_DEBUG) {
+        total += DEBUG_CANARY_SIZE;
+    }
+    return total;
+}
+
+// Função auxiliar para gravar o canário após os dados (backend debug)
+static void write_canary(BlockHeader* header) {
+    memset((char*)(header + 1) + header->info.size, DEBUG_FILL_CANARY, DEBUG_CANARY_SIZE);
+}
+
+// Função auxiliar para validar um bloco antes de liberá-lo ou realocá-lo
+static int check_block(Allocator* allocator, BlockHeader* header) {
+    if (allocator->backend != ALLOC_DEBUG) {
+        return 1;
+    }
+    int valid = header->info.magic == BLOCK_MAGIC;
+    if (valid) {
+        const unsigned char* canary = (const unsigned char*)(header + 1) + header->info.size;
+        for (int i = 0; i < DEBUG_CANARY_SIZE; i++) {
+            if (canary[i] != DEBUG_FILL_CANARY) {
+                valid = 0;
+                break;
+            }
+        }
+    }
+    if (!valid) {
+        allocator->corruptions++;
+        fprintf(stderr, "Erro: bloco de memória corrompido ou liberado duas vezes (%p).\n", (void*)(header + 1));
+    }
+    return valid;
+}
+
+// Funções auxiliares para atualizar os contadores
+static void account_add(Allocator* allocator, MemTag tag, long long bytes) {
+    MemStats* stats = &allocator->stats[tag];
+    stats->bytes += bytes;
+    if (stats->bytes > stats->peak_bytes) {
+        stats->peak_bytes = stats->bytes;
+    }
+    allocator->bytes += bytes;
+    if (allocator->bytes > allocator->peak_bytes) {
+        allocator->peak_bytes = allocator->bytes;
+    }
+}
+
+// Função de alocação
+void* mem_alloc(Allocator* allocator, MemTag tag, size_t size) {
+    size_t total = raw_size(allocator, size);
+    BlockHeader* header = allocator->backend == ALLOC_ARENA ?
+        (BlockHeader*)arena_alloc(allocator, total) : (BlockHeader*)malloc(total);
+    if (header == NULL) {
+        return NULL;
+    }
+    header->info.size = size;
+    header->info.tag = tag;
+    header->info.magic = BLOCK_MAGIC;
+    if (allocator->backend == ALLOC_DEBUG) {
+        memset(header + 1, DEBUG_FILL_NEW, size);
+        write_canary(header);
+    }
+
+    allocator->stats[tag].allocs++;
+    allocator->stats[tag].total_bytes += size;
+    account_add(allocator, tag, (long long)size);
+    return header + 1;
+}
+
+// Função de realocação (o subsistema original do bloco é mantido)
+void* mem_realloc(Allocator* allocator, MemTag tag, void* ptr, size_t size) {
+    if (ptr == NULL) {
+        return mem_alloc(allocator, tag, size);
+    }
+    BlockHeader* header = (BlockHeader*)ptr - 1;
+    if (!check_block(allocator, header)) {
+        return NULL;
+    }
+    size_t old_size = header->info.size;
+    MemTag block_tag = (MemTag)header->info.tag;
+
+    BlockHeader* moved;
+    if (allocator->backend == ALLOC_ARENA) {
+        moved = (BlockHeader*)arena_realloc(allocator, header, raw_size(allocator, old_size), raw_size(allocator, size));
+    } else {
+        moved = (BlockHeader*)realloc(header, raw_size(allocator, size));
+    }
+    if (moved == NULL) {
+        return NULL;
+    }
+    moved->info.size = size;
+    if (allocator->backend == ALLOC_DEBUG) {
+        if (size > old_size) {
+            memset((char*)(moved + 1) + old_size, DEBUG_FILL_NEW, size - old_size);
+        }
+        write_canary(moved);
+    }
+
+    MemStats* stats = &allocator->stats[block_tag];
+    stats->reallocs++;
+    if (moved != header) {
+        stats->realloc_moved += (long long)old_size;
+    }
+    if (size > old_size) {
+        stats->total_bytes += (long long)(size - old_size);
+    }
+    account_add(allocator, block_tag, (long long)size - (long long)old_size);
+    return moved + 1;
+}
+
+// Função de liberação
+void mem_free(Allocator* allocator, void* ptr) {
+    if (ptr == NULL) {
+        return;
+    }
+    BlockHeader* header = (BlockHeader*)ptr - 1;
+    if (!check_block(allocator, header)) {
+        return;
+    }
+    MemTag tag = (MemTag)header->info.tag;
+    size_t size = header->info.size;
+    allocator->stats[tag].frees++;
+    account_add(allocator, tag, -(long long)size);
+
+    switch (allocator->backend) {
+        case ALLOC_SYSTEM:
+            free(header);
+            break;
+        case ALLOC_ARENA:
+            // A memória só volta ao sistema em allocator_free
+            break;
+        case ALLOC_DEBUG:
+            memset(header + 1, DEBUG_FILL_FREED, size + DEBUG_CANARY_SIZE);
+            header->info.magic = BLOCK_FREED;
+            free(header);
+            break;
+    }
+}
+
+// Função para duplicar os primeiros length bytes de uma string
+char* mem_strndup(Allocator* allocator, MemTag tag, const char* s, size_t length) {
+    char* copy = (char*)mem_alloc(allocator, tag, length + 1);
+    if (copy == NULL) {
+        return NULL;
+    }
+    memcpy(copy, s, length);
+    copy[length] = '\0';
+    return copy;
+}
+
+// Linha de texto montada sem stdio (seguro em tratadores de sinal)
+typedef struct {
+    char data[256];
+    int length;
+} StatsLine;
+
+// Função auxiliar para acrescentar texto alinhado à esquerda
+static void put_text(StatsLine* line, const char* text, int width) {
+    int columns = 0;
+    for (const char* c = text; *c != '\0' && line->length < (int)sizeof(line->data) - 1; c++) {
+        line->data[line->length++] = *c;
+        if (((unsigned char)*c & 0xC0) != 0x80) {
+            columns++; // Conta caracteres UTF-8, não bytes
+        }
+    }
+    while (columns++ < width && line->length < (int)sizeof(line->data) - 1) {
+        line->data[line->length++] = ' ';
+    }
+}
+
+// Função auxiliar para acrescentar um número alinhado à direita
+static void put_number(StatsLine* line, long long value, int width) {
+    char digits[24];
+    int n = 0;
+    int negative = value < 0;
+    unsigned long long magnitude = negative ? (unsigned long long)(-(value + 1)) + 1 : (unsigned long long)value;
+    do {
+        digits[n++] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+    if (negative) {
+        digits[n++] = '-';
+    }
+    for (int pad = n; pad < width && line->length < (int)sizeof(line->data) - 1; pad++) {
+        line->data[line->length++] = ' ';
+    }
+    while (n > 0 && line->length < (int)sizeof(line->data) - 1) {
+        line->data[line->length++] = digits[--n];
+    }
+}
+
+// Função auxiliar para terminar e escrever a linha
+static void put_line(StatsLine* line, int fd) {
+    line->data[line->length++] = '\n';
+    ssize_t written = write(fd, line->data, line->length);
+    (void)written;
+    line->length = 0;
+}
+
+// Função auxiliar para somar os contadores de um subsistema
+static void add_stats(MemStats* into, const MemStats* from) {
+    into->allocs += from->allocs;
+    into->frees += from->frees;
+    into->reallocs += from->reallocs;
+    into->bytes += from->bytes;
+    into->peak_bytes += from->peak_bytes;
+    into->total_bytes += from->total_bytes;
+    into->realloc_moved += from->realloc_moved;
+}
+
+// Função para somar os contadores de um alocador aos de outro
+void mem_stats_merge(Allocator* into, const Allocator* from) {
+    for (int i = 0; i < MEM_TAG_COUNT; i++) {
+        add_stats(&into->stats[i], &from->stats[i]);
+    }
+    into->bytes += from->bytes;
+    into->peak_bytes += from->peak_bytes;
+    into->corruptions += from->corruptions;
+}
+
+// Função para escrever as estatísticas em um descritor de arquivo
+void mem_stats_write(const Allocator* allocator, int fd) {
+    mem_stats_write_merged(allocator, NULL, fd);
+}
+
+// Função para escrever as estatísticas de um alocador somadas às de outro
+void mem_stats_write_merged(const Allocator* allocator, const Allocator* extra, int fd) {
+    StatsLine line;
+    line.length = 0;
+    put_text(&line, "=== Memória (backend: ", 0);
+    put_text(&line, allocator_backend_name(allocator->backend), 0);
+    put_text(&line, ") ===", 0);
+    put_line(&line, fd);
+
+    put_text(&line, "subsistema", 14);
+    put_text(&line, "   alocações", 0);
+    put_text(&line, "  liberações", 0);
+    put_text(&line, "   reallocs", 0);
+    put_text(&line, "   em uso (B)", 0);
+    put_text(&line, "     pico (B)", 0);
+    put_text(&line, "    total (B)", 0);
+    put_text(&line, "  realloc movido (B)", 0);
+    put_line(&line, fd);
+
+    MemStats total;
+    memset(&total, 0, sizeof(total));
+    for (int i = 0; i <= MEM_TAG_COUNT; i++) {
+        MemStats row;
+        const MemStats* stats = &row;
+        if (i < MEM_TAG_COUNT) {
+            row = allocator->stats[i];
+            if (extra != NULL) {
+                add_stats(&row, &extra->stats[i]);
+            }
+            add_stats(&total, &row);
+        } else {
+            // O pico de cada subsistema ocorre em momentos diferentes: usa o pico conjunto
+            total.peak_bytes = allocator->peak_bytes + (extra != NULL ? extra->peak_bytes : 0);
+            stats = &total;
+        }
+        put_text(&line, i < MEM_TAG_COUNT ? tag_names[i] : "total", 14);
+        put_number(&line, stats->allocs, 12);
+        put_number(&line, stats->frees, 12);
+        put_number(&line, stats->reallocs, 11);
+        put_number(&line, stats->bytes, 13);
+        put_number(&line, stats->peak_bytes, 13);
+        put_number(&line, stats->total_bytes, 13);
+        put_number(&line, stats->realloc_moved, 20);
+        put_line(&line, fd);
+    }
+
+    long long corruptions = allocator->corruptions + (extra != NULL ? extra->corruptions : 0);
+    if (corruptions > 0) {
+        put_text(&line, "Blocos corrompidos detectados: ", 0);
+        put_number(&line, corruptions, 0);
+        put_line(&line, fd);
+    }
+}
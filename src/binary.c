@@ -0,0 +1,571 @@
+
+/* binary.c */
+
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "binary.h"
+#include "iterator.h"
+#include "dict.h"
+
+// Marca de ordem de bytes gravada no cabeçalho
+#define BINARY_BYTE_ORDER 0x01020304u
+
+// Arquivo em construção: as estruturas são montadas num buffer contínuo e
+// referenciadas por deslocamento, já que o buffer muda de lugar ao crescer
+typedef struct {
+    Allocator* allocator;
+    char* data;
+    size_t length;
+    size_t capacity;
+    uint64_t* relocs;
+    size_t num_relocs;
+    size_t reloc_capacity;
+    int failed;
+} Writer;
+
+// Função auxiliar para reservar uma região zerada e alinhada; devolve o deslocamento
+static size_t reserve(Writer* w, size_t size, size_t align) {
+    size_t offset = (w->length + align - 1) & ~(align - 1);
+    size_t end = offset + size;
+    if (end > w->capacity) {
+        size_t capacity = w->capacity == 0 ? 4096 : w->capacity;
+        while (capacity < end) {
+            capacity *= 2;
+        }
+        char* data = (char*)mem_realloc(w->allocator, MEM_INTERPRETER, w->data, capacity);
+        if (data == NULL) {
+            w->failed = 1;
+            return 0;
+        }
+        w->data = data;
+        w->capacity = capacity;
+    }
+    memset(w->data + w->length, 0, end - w->length);
+    w->length = end;
+    return offset;
+}
+
+// Função auxiliar para gravar um ponteiro (como deslocamento) e registrar a relocação
+static void set_pointer(Writer* w, size_t slot, size_t target) {
+    if (w->failed) {
+        return;
+    }
+    if (w->num_relocs == w->reloc_capacity) {
+        size_t capacity = w->reloc_capacity == 0 ? 256 : w->reloc_capacity * 2;
+        uint64_t* relocs = (uint64_t*)mem_realloc(w->allocator, MEM_INTERPRETER, w->relocs, capacity * sizeof(uint64_t));
+        if (relocs == NULL) {
+            w->failed = 1;
+            return;
+        }
+        w->relocs = relocs;
+        w->reloc_capacity = capacity;
+    }
+    uintptr_t pointer = (uintptr_t)target;
+    memcpy(w->data + slot, &pointer, sizeof(pointer));
+    w->relocs[w->num_relocs++] = slot;
+}
+
+static size_t write_list(Writer* w, const List* list);
+static size_t write_dict(Writer* w, const Dict* dict);
+
+// Função auxiliar para gravar uma string terminada em '\0'
+static size_t write_string(Writer* w, const char* s) {
+    size_t length = strlen(s) + 1;
+    size_t offset = reserve(w, length, 1);
+    if (!w->failed) {
+        memcpy(w->data + offset, s, length);
+    }
+    return offset;
+}
+
+// Função auxiliar para gravar um Value na posição slot (já reservada)
+static void write_value(Writer* w, size_t slot, Value value) {
+    size_t target = 0;
+    switch (value.type) {
+        case VALUE_STRING: target = write_string(w, value.data.string_val); break;
+        case VALUE_LIST: target = write_list(w, (const List*)value.data.list_val); break;
+        case VALUE_DICT: target = write_dict(w, (const Dict*)value.data.dict_val); break;
+        default: break;
+    }
+    if (w->failed) {
+        return;
+    }
+
+    // Montado a partir de zeros para o arquivo não levar bytes de preenchimento soltos
+    Value stored;
+    memset(&stored, 0, sizeof(stored));
+    stored.type = value.type;
+    if (value.type == VALUE_INTEGER) {
+        stored.data.int_val = value.data.int_val;
+    } else if (value.type == VALUE_FLOAT) {
+        stored.data.float_val = value.data.float_val;
+    }
+    memcpy(w->data + slot, &stored, sizeof(stored));
+    if (target != 0) {
+        set_pointer(w, slot + offsetof(Value, data), target);
+    }
+}
+
+// Função auxiliar para escolher a representação gravada de uma lista:
+// listas só de int ou só de float viram vetores tipados
+static ListKind stored_kind(const List* list) {
+    if (list->kind != LIST_VALUES || list->count == 0) {
+        return list->kind;
+    }
+    ValueType first = list->items[0].type;
+    if (first != VALUE_INTEGER && first != VALUE_FLOAT) {
+        return LIST_VALUES;
+    }
+    for (int i = 1; i < list->count; i++) {
+        if (list->items[i].type != first) {
+            return LIST_VALUES;
+        }
+    }
+    return first == VALUE_INTEGER ? LIST_INTS : LIST_FLOATS;
+}
+
+// Função auxiliar para gravar uma lista; devolve o deslocamento do cabeçalho
+static size_t write_list(Writer* w, const List* list) {
+    ListKind kind = stored_kind(list);
+    size_t offset = reserve(w, sizeof(List), 8);
+    size_t items = 0;
+    if (list->count > 0) {
+        if (kind == LIST_VALUES) {
+            items = reserve(w, list->count * sizeof(Value), 8);
+            for (int i = 0; i < list->count && !w->failed; i++) {
+                write_value(w, items + i * sizeof(Value), list_get(list, i));
+            }
+        } else {
+            // Vetor tipado: array cru alinhado, sem nenhuma relocação por item
+            items = reserve(w, list->count * sizeof(int), BINARY_ARRAY_ALIGN);
+            for (int i = 0; i < list->count && !w->failed; i++) {
+                Value item = list_get(list, i);
+                if (kind == LIST_INTS) {
+                    memcpy(w->data + items + i * sizeof(int), &item.data.int_val, sizeof(int));
+                } else {
+                    memcpy(w->data + items + i * sizeof(float), &item.data.float_val, sizeof(float));
+                }
+            }
+        }
+    }
+    if (w->failed) {
+        return 0;
+    }
+
+    List stored;
+    memset(&stored, 0, sizeof(stored));
+    stored.kind = kind;
+    stored.count = list->count;
+    stored.capacity = list->count;
+    memcpy(w->data + offset, &stored, sizeof(stored));
+    if (items != 0) {
+        set_pointer(w, offset + (kind == LIST_VALUES ? offsetof(List, items) : offsetof(List, raw)), items);
+    }
+    set_pointer(w, offset + offsetof(List, image), offsetof(BinaryHeader, image));
+    return offset;
+}
+
+// Função auxiliar para gravar um dicionário com a tabela hash como está,
+// para a carga não precisar reconstruir o índice
+static size_t write_dict(Writer* w, const Dict* dict) {
+    size_t offset = reserve(w, sizeof(Dict), 8);
+    size_t entries = reserve(w, dict->capacity * sizeof(DictEntry), 8);
+    for (int i = 0; i < dict->capacity && !w->failed; i++) {
+        const DictEntry* entry = &dict->entries[i];
+        if (entry->key == NULL) {
+            continue;
+        }
+        size_t slot = entries + i * sizeof(DictEntry);
+        size_t key = write_string(w, entry->key);
+        write_value(w, slot + offsetof(DictEntry, value), entry->value);
+        if (w->failed) {
+            break;
+        }
+        memcpy(w->data + slot + offsetof(DictEntry, hash), &entry->hash, sizeof(entry->hash));
+        set_pointer(w, slot + offsetof(DictEntry, key), key);
+    }
+    if (w->failed) {
+        return 0;
+    }
+
+    Dict stored;
+    memset(&stored, 0, sizeof(stored));
+    stored.count = dict->count;
+    stored.capacity = dict->capacity;
+    memcpy(w->data + offset, &stored, sizeof(stored));
+    set_pointer(w, offset + offsetof(Dict, entries), entries);
+    set_pointer(w, offset + offsetof(Dict, image), offsetof(BinaryHeader, image));
+    return offset;
+}
+
+// Função auxiliar para gravar tudo, tratando escritas parciais
+static int write_all(int fd, const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t written = write(fd, data, length);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return 0;
+        }
+        data += written;
+        length -= (size_t)written;
+    }
+    return 1;
+}
+
+// Função para gravar um valor em um arquivo
+BinaryStatus binary_save(Allocator* allocator, Value value, const char* path) {
+    Writer w;
+    memset(&w, 0, sizeof(w));
+    w.allocator = allocator;
+
+    size_t header = reserve(&w, sizeof(BinaryHeader), 8);
+    size_t root = reserve(&w, sizeof(Value), 8);
+    write_value(&w, root, value);
+    size_t relocs = reserve(&w, w.num_relocs * sizeof(uint64_t), 8);
+
+    BinaryStatus status = BINARY_OK;
+    if (w.failed) {
+        status = BINARY_NO_MEMORY;
+    } else {
+        if (w.num_relocs > 0) {
+            memcpy(w.data + relocs, w.relocs, w.num_relocs * sizeof(uint64_t));
+        }
+        BinaryHeader h;
+        memset(&h, 0, sizeof(h));
+        memcpy(h.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC));
+        h.version = BINARY_VERSION;
+        h.byte_order = BINARY_BYTE_ORDER;
+        h.value_size = sizeof(Value);
+        h.pointer_size = sizeof(void*);
+        h.file_size = w.length;
+        h.root = root;
+        h.relocs = relocs;
+        h.num_relocs = w.num_relocs;
+        memcpy(w.data + header, &h, sizeof(h));
+
+        // Grava num arquivo temporário e renomeia: quem lê nunca vê um arquivo pela metade
+        char temp[1024];
+        int length = snprintf(temp, sizeof(temp), "%s.tmp", path);
+        int fd = length >= 0 && (size_t)length < sizeof(temp) ? open(temp, O_WRONLY | O_CREAT | O_TRUNC, 0644) : -1;
+        if (fd < 0) {
+            status = BINARY_IO_ERROR;
+        } else {
+            int ok = write_all(fd, w.data, w.length);
+            if (close(fd) != 0 || !ok || rename(temp, path) != 0) {
+                unlink(temp);
+                status = BINARY_IO_ERROR;
+            }
+        }
+    }
+
+    mem_free(allocator, w.data);
+    mem_free(allocator, w.relocs);
+    return status;
+}
+
+// Limite de aninhamento aceito na carga (listas e dicionários uns dentro dos outros)
+#define BINARY_MAX_DEPTH 10000
+
+// Marcas por palavra do arquivo usadas na verificação da carga
+#define MARK_RELOCATED 1 // A palavra é um ponteiro listado na tabela de relocações
+#define MARK_USED 2      // ...e foi lida como campo de ponteiro de algum nó alcançável
+#define MARK_VISITING 4  // Nó em verificação (achá-lo de novo é um ciclo)
+#define MARK_LIST 8      // Lista já verificada
+#define MARK_DICT 16     // Dicionário já verificado
+
+// Estado da verificação do grafo carregado
+typedef struct {
+    char* base;
+    size_t size;
+    unsigned char* marks; // Uma marca por palavra de sizeof(uintptr_t) bytes
+    int depth;
+} Checker;
+
+static int check_value(Checker* c, const Value* value);
+
+// Função auxiliar para verificar uma região do corpo do arquivo (fora do cabeçalho)
+static int check_range(const Checker* c, size_t offset, size_t length, size_t align) {
+    return offset % align == 0 && offset >= sizeof(BinaryHeader) &&
+           length <= c->size && offset <= c->size - length;
+}
+
+// Função auxiliar para ler um campo de ponteiro de um nó já verificado.
+// Retorna 1 se ele foi relocado (deslocamento em *offset), 0 se é NULL e -1 se
+// não é nenhum dos dois.
+static int pointer_field(Checker* c, const void* field, size_t* offset) {
+    size_t word = (size_t)((const char*)field - c->base) / sizeof(uintptr_t);
+    uintptr_t pointer;
+    memcpy(&pointer, field, sizeof(pointer));
+    if (c->marks[word] & MARK_RELOCATED) {
+        c->marks[word] |= MARK_USED;
+        *offset = (size_t)(pointer - (uintptr_t)c->base);
+        return 1;
+    }
+    return pointer == 0 ? 0 : -1;
+}
+
+// Função auxiliar para verificar o campo image de uma lista ou dicionário
+static int check_image(Checker* c, const void* field) {
+    size_t offset;
+    return pointer_field(c, field, &offset) == 1 && offset == offsetof(BinaryHeader, image);
+}
+
+// Função auxiliar para verificar uma string terminada em '\0' dentro do arquivo
+static int check_string(const Checker* c, size_t offset) {
+    return check_range(c, offset, 1, 1) && memchr(c->base + offset, '\0', c->size - offset) != NULL;
+}
+
+// Função auxiliar para marcar a entrada num nó; devolve 0 em ciclo ou aninhamento demais
+static int enter_node(Checker* c, size_t offset) {
+    unsigned char* mark = &c->marks[offset / sizeof(uintptr_t)];
+    if ((*mark & MARK_VISITING) || c->depth >= BINARY_MAX_DEPTH) {
+        return 0;
+    }
+    *mark |= MARK_VISITING;
+    c->depth++;
+    return 1;
+}
+
+// Função auxiliar para marcar a saída de um nó já verificado
+static void leave_node(Checker* c, size_t offset, unsigned char done) {
+    unsigned char* mark = &c->marks[offset / sizeof(uintptr_t)];
+    *mark = (unsigned char)((*mark & ~MARK_VISITING) | done);
+    c->depth--;
+}
+
+// Função auxiliar para verificar uma lista e seus itens
+static int check_list(Checker* c, size_t offset) {
+    if (!check_range(c, offset, sizeof(List), 8)) {
+        return 0;
+    }
+    if (c->marks[offset / sizeof(uintptr_t)] & MARK_LIST) {
+        return 1; // Compartilhada com outro ponto do grafo
+    }
+    const List* list = (const List*)(c->base + offset);
+    if ((list->kind != LIST_VALUES && list->kind != LIST_INTS && list->kind != LIST_FLOATS) ||
+        list->count < 0 || list->capacity < list->count || !check_image(c, &list->image)) {
+        return 0;
+    }
+
+    // Só o campo do tipo da lista aponta para os elementos; o outro é NULL
+    size_t items = 0;
+    size_t raw = 0;
+    int has_items = pointer_field(c, &list->items, &items);
+    int has_raw = pointer_field(c, &list->raw, &raw);
+    if (list->kind == LIST_VALUES) {
+        if (has_raw != 0 || has_items < 0 || (has_items == 0 && list->count > 0) ||
+            (has_items == 1 && !check_range(c, items, (size_t)list->count * sizeof(Value), 8))) {
+            return 0;
+        }
+    } else {
+        if (has_items != 0 || has_raw < 0 || (has_raw == 0 && list->count > 0) ||
+            (has_raw == 1 && !check_range(c, raw, (size_t)list->count * sizeof(int), sizeof(int)))) {
+            return 0;
+        }
+    }
+
+    if (!enter_node(c, offset)) {
+        return 0;
+    }
+    for (int i = 0; list->kind == LIST_VALUES && i < list->count; i++) {
+        if (!check_value(c, (const Value*)(c->base + items) + i)) {
+            return 0;
+        }
+    }
+    leave_node(c, offset, MARK_LIST);
+    return 1;
+}
+
+// Função auxiliar para verificar um dicionário, suas chaves e valores
+static int check_dict(Checker* c, size_t offset) {
+    if (!check_range(c, offset, sizeof(Dict), 8)) {
+        return 0;
+    }
+    if (c->marks[offset / sizeof(uintptr_t)] & MARK_DICT) {
+        return 1;
+    }
+    const Dict* dict = (const Dict*)(c->base + offset);
+    size_t entries;
+    // Capacidade potência de 2 com ao menos uma vaga livre: a sondagem sempre termina
+    if (dict->capacity <= 0 || (dict->capacity & (dict->capacity - 1)) != 0 ||
+        dict->count < 0 || dict->count >= dict->capacity || !check_image(c, &dict->image) ||
+        pointer_field(c, &dict->entries, &entries) != 1 ||
+        !check_range(c, entries, (size_t)dict->capacity * sizeof(DictEntry), 8)) {
+        return 0;
+    }
+
+    if (!enter_node(c, offset)) {
+        return 0;
+    }
+    int keys = 0;
+    for (int i = 0; i < dict->capacity; i++) {
+        const DictEntry* entry = (const DictEntry*)(c->base + entries) + i;
+        size_t key;
+        int has_key = pointer_field(c, &entry->key, &key);
+        if (has_key == 0) {
+            continue;
+        }
+        if (has_key < 0 || !check_string(c, key) || entry->hash != dict_hash(c->base + key) ||
+            !check_value(c, &entry->value)) {
+            return 0;
+        }
+        keys++;
+    }
+    if (keys != dict->count) {
+        return 0;
+    }
+    leave_node(c, offset, MARK_DICT);
+    return 1;
+}
+
+// Função auxiliar para verificar um Value e o que ele referencia
+static int check_value(Checker* c, const Value* value) {
+    size_t target;
+    int has_target = pointer_field(c, &value->data, &target);
+    switch (value->type) {
+        case VALUE_INTEGER:
+        case VALUE_FLOAT:
+        case VALUE_NULL:
+            return has_target != 1; // Um número não pode ter sido relocado
+        case VALUE_STRING: return has_target == 1 && check_string(c, target);
+        case VALUE_LIST: return has_target == 1 && check_list(c, target);
+        case VALUE_DICT: return has_target == 1 && check_dict(c, target);
+    }
+    return 0;
+}
+
+// Função para carregar um valor gravado por binary_save
+BinaryStatus binary_load(Allocator* allocator, const char* path, Value* value) {
+    value->type = VALUE_NULL;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return BINARY_IO_ERROR;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return BINARY_IO_ERROR;
+    }
+    size_t size = (size_t)st.st_size;
+    if (size < sizeof(BinaryHeader)) {
+        close(fd);
+        return BINARY_BAD_FORMAT;
+    }
+    // Mapeamento privado: as relocações e as contagens de referência
+    // escrevem em cópias das páginas, nunca no arquivo
+    char* base = (char*)mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        return BINARY_IO_ERROR;
+    }
+
+    BinaryHeader* header = (BinaryHeader*)base;
+    BinaryStatus status = BINARY_OK;
+    if (memcmp(header->magic, BINARY_MAGIC, sizeof(BINARY_MAGIC)) != 0) {
+        status = BINARY_BAD_FORMAT;
+    } else if (header->version != BINARY_VERSION || header->byte_order != BINARY_BYTE_ORDER ||
+               header->value_size != sizeof(Value) || header->pointer_size != sizeof(void*)) {
+        status = BINARY_UNSUPPORTED;
+    } else if (header->file_size != size || header->root % 8 != 0 || header->root > size - sizeof(Value) ||
+               header->relocs % 8 != 0 || header->relocs > size ||
+               header->num_relocs > (size - header->relocs) / sizeof(uint64_t)) {
+        status = BINARY_BAD_FORMAT;
+    }
+
+    Checker checker;
+    checker.base = base;
+    checker.size = size;
+    checker.depth = 0;
+    checker.marks = NULL;
+    if (status == BINARY_OK) {
+        checker.marks = (unsigned char*)mem_alloc(allocator, MEM_INTERPRETER, size / sizeof(uintptr_t) + 1);
+        if (checker.marks == NULL) {
+            status = BINARY_NO_MEMORY;
+        } else {
+            memset(checker.marks, 0, size / sizeof(uintptr_t) + 1);
+        }
+    }
+
+    // Correção dos ponteiros: cada relocação vira endereço base + deslocamento.
+    // Uma relocação não pode cair no cabeçalho, na própria tabela nem repetir.
+    const uint64_t* relocs = (const uint64_t*)(base + (status == BINARY_OK ? header->relocs : 0));
+    uint64_t relocs_end = status == BINARY_OK ? header->relocs + header->num_relocs * sizeof(uint64_t) : 0;
+    for (uint64_t i = 0; status == BINARY_OK && i < header->num_relocs; i++) {
+        uint64_t slot = relocs[i];
+        if (slot % sizeof(uintptr_t) != 0 || slot > size - sizeof(uintptr_t) || slot < sizeof(BinaryHeader) ||
+            (slot >= header->relocs && slot < relocs_end) ||
+            (checker.marks[slot / sizeof(uintptr_t)] & MARK_RELOCATED)) {
+            status = BINARY_BAD_FORMAT;
+            break;
+        }
+        uintptr_t* pointer = (uintptr_t*)(base + slot);
+        if (*pointer >= size) {
+            status = BINARY_BAD_FORMAT;
+            break;
+        }
+        *pointer += (uintptr_t)base;
+        checker.marks[slot / sizeof(uintptr_t)] |= MARK_RELOCATED;
+    }
+
+    // Verificação do grafo alcançável pela raiz, uma vez só por nó; toda
+    // relocação tem que ter sido um campo de ponteiro de algum desses nós
+    if (status == BINARY_OK && (header->root < sizeof(BinaryHeader) ||
+                                !check_value(&checker, (const Value*)(base + header->root)))) {
+        status = BINARY_BAD_FORMAT;
+    }
+    for (uint64_t i = 0; status == BINARY_OK && i < header->num_relocs; i++) {
+        if (!(checker.marks[relocs[i] / sizeof(uintptr_t)] & MARK_USED)) {
+            status = BINARY_BAD_FORMAT;
+        }
+    }
+    mem_free(allocator, checker.marks);
+    if (status != BINARY_OK) {
+        munmap(base, size);
+        return status;
+    }
+
+    header->image.refs = 1;
+    header->image.base = base;
+    header->image.size = size;
+    Value root = *(const Value*)(base + header->root);
+    if (root.type == VALUE_LIST || root.type == VALUE_DICT) {
+        *value = root; // A referência inicial do arquivo passa ao valor devolvido
+        return BINARY_OK;
+    }
+    if (!copy_value(allocator, root, value)) {
+        status = BINARY_NO_MEMORY;
+    }
+    munmap(base, size);
+    return status;
+}
+
+// Função para obter a descrição de um resultado
+const char* binary_status_message(BinaryStatus status) {
+    switch (status) {
+        case BINARY_OK: return "sucesso";
+        case BINARY_IO_ERROR: return "não foi possível ler ou gravar o arquivo";
+        case BINARY_BAD_FORMAT: return "arquivo binário inválido ou corrompido";
+        case BINARY_UNSUPPORTED: return "versão ou arquitetura do arquivo não suportada";
+        case BINARY_NO_MEMORY: return "falta de memória";
+    }
+    return "?";
+}
+
+// Função para soltar uma referência ao arquivo mapeado
+void image_release(MappedImage* image) {
+    if (--image->refs > 0) {
+        return;
+    }
+    // A estrutura mora dentro do próprio mapeamento
+    void* base = image->base;
+    size_t size = image->size;
+    munmap(base, size);
+}
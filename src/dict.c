@@ -0,0 +1,130 @@
+
+/* dict.c */
+
+#include <string.h>
+#include "dict.h"
+#include "binary.h"
+
+// Capacidade inicial da tabela (potência de 2)
+#define DICT_INITIAL_CAPACITY 8
+
+// Função para calcular o hash de uma chave (FNV-1a)
+unsigned int dict_hash(const char* key) {
+    unsigned int hash = 2166136261u;
+    for (const unsigned char* p = (const unsigned char*)key; *p != '\0'; p++) {
+        hash ^= *p;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Função para criar um dicionário vazio
+Dict* dict_new(Allocator* allocator) {
+    Dict* dict = (Dict*)mem_alloc(allocator, MEM_INTERPRETER, sizeof(Dict));
+    if (dict == NULL) {
+        return NULL;
+    }
+    dict->entries = (DictEntry*)mem_alloc(allocator, MEM_INTERPRETER, DICT_INITIAL_CAPACITY * sizeof(DictEntry));
+    if (dict->entries == NULL) {
+        mem_free(allocator, dict);
+        return NULL;
+    }
+    memset(dict->entries, 0, DICT_INITIAL_CAPACITY * sizeof(DictEntry));
+    dict->refs = 1;
+    dict->count = 0;
+    dict->capacity = DICT_INITIAL_CAPACITY;
+    dict->image = NULL;
+    return dict;
+}
+
+// Função auxiliar para achar a posição de uma chave (ou a vaga onde ela entraria)
+static DictEntry* find_entry(DictEntry* entries, int capacity, const char* key, unsigned int hash) {
+    unsigned int mask = (unsigned int)capacity - 1;
+    for (unsigned int i = hash & mask;; i = (i + 1) & mask) {
+        DictEntry* entry = &entries[i];
+        if (entry->key == NULL || (entry->hash == hash && strcmp(entry->key, key) == 0)) {
+            return entry;
+        }
+    }
+}
+
+// Função auxiliar para dobrar a tabela, reposicionando as entradas
+static int grow(Allocator* allocator, Dict* dict) {
+    int capacity = dict->capacity * 2;
+    DictEntry* entries = (DictEntry*)mem_alloc(allocator, MEM_INTERPRETER, capacity * sizeof(DictEntry));
+    if (entries == NULL) {
+        return 0;
+    }
+    memset(entries, 0, capacity * sizeof(DictEntry));
+    for (int i = 0; i < dict->capacity; i++) {
+        DictEntry* old = &dict->entries[i];
+        if (old->key != NULL) {
+            *find_entry(entries, capacity, old->key, old->hash) = *old;
+        }
+    }
+    mem_free(allocator, dict->entries);
+    dict->entries = entries;
+    dict->capacity = capacity;
+    return 1;
+}
+
+// Função para associar um valor a uma chave
+int dict_set(Allocator* allocator, Dict* dict, const char* key, Value value) {
+    // Mantém a ocupação abaixo de 3/4 para as sondagens continuarem curtas
+    if ((dict->count + 1) * 4 > dict->capacity * 3 && !grow(allocator, dict)) {
+        return 0;
+    }
+    unsigned int hash = dict_hash(key);
+    DictEntry* entry = find_entry(dict->entries, dict->capacity, key, hash);
+    if (entry->key != NULL) {
+        free_value(allocator, entry->value);
+        entry->value = value;
+        return 1;
+    }
+    entry->key = mem_strndup(allocator, MEM_INTERPRETER, key, strlen(key));
+    if (entry->key == NULL) {
+        return 0;
+    }
+    entry->hash = hash;
+    entry->value = value;
+    dict->count++;
+    return 1;
+}
+
+// Função para buscar uma chave
+const Value* dict_get(const Dict* dict, const char* key) {
+    DictEntry* entry = find_entry(dict->entries, dict->capacity, key, dict_hash(key));
+    return entry->key != NULL ? &entry->value : NULL;
+}
+
+// Função para tomar mais uma referência
+void dict_retain(Dict* dict) {
+    // Dicionários de um arquivo mapeado compartilham a contagem do arquivo
+    if (dict->image != NULL) {
+        dict->image->refs++;
+    } else {
+        dict->refs++;
+    }
+}
+
+// Função para soltar uma referência; o dicionário é liberado na última
+void dict_release(Allocator* allocator, Dict* dict) {
+    if (dict == NULL) {
+        return;
+    }
+    if (dict->image != NULL) {
+        image_release(dict->image);
+        return;
+    }
+    if (--dict->refs > 0) {
+        return;
+    }
+    for (int i = 0; i < dict->capacity; i++) {
+        if (dict->entries[i].key != NULL) {
+            mem_free(allocator, dict->entries[i].key);
+            free_value(allocator, dict->entries[i].value);
+        }
+    }
+    mem_free(allocator, dict->entries);
+    mem_free(allocator, dict);
+}
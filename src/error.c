@@ -0,0 +1,33 @@
+
+/* error.c */
+
+#include <stdio.h>
+#include "error.h"
+
+// Função para inicializar (limpar) um erro
+void error_init(RodyError* error) {
+    error->has_error = 0;
+    error->line = 0;
+    error->column = 0;
+    error->message[0] = '\0';
+}
+
+// Versão de error_set que recebe uma va_list
+void error_vset(RodyError* error, int line, int column, const char* format, va_list args) {
+    // Mantém apenas o primeiro erro para não mascarar a causa original
+    if (error->has_error) {
+        return;
+    }
+    error->has_error = 1;
+    error->line = line;
+    error->column = column;
+    vsnprintf(error->message, sizeof(error->message), format, args);
+}
+
+// Função para registrar um erro; apenas o primeiro erro é mantido
+void error_set(RodyError* error, int line, int column, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    error_vset(error, line, column, format, args);
+    va_end(args);
+}
@@ -0,0 +1,208 @@
+
+/* input.c */
+
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include "input.h"
+
+// Função para inicializar o buffer de entrada para um descritor
+void input_init(InputBuffer* in, int fd, Allocator* allocator, OutputBuffer* output) {
+    in->fd = fd;
+    in->data = NULL;
+    in->start = 0;
+    in->end = 0;
+    in->scanned = 0;
+    in->capacity = 0;
+    in->eof = 0;
+    in->allocator = allocator;
+    in->output = output;
+}
+
+// Função para liberar o buffer de entrada
+void input_free(InputBuffer* in) {
+    mem_free(in->allocator, in->data);
+    in->data = NULL;
+    in->capacity = 0;
+    in->start = in->end = in->scanned = 0;
+}
+
+// Função para trocar o descritor de origem (descarta dados pendentes)
+void input_set_fd(InputBuffer* in, int fd) {
+    in->fd = fd;
+    in->start = in->end = in->scanned = 0;
+    in->eof = 0;
+}
+
+// Função auxiliar para ler do descritor, repetindo se interrompido por sinal
+static ssize_t read_retry(int fd, char* data, size_t length) {
+    ssize_t n;
+    do {
+        n = read(fd, data, length);
+    } while (n < 0 && errno == EINTR);
+    return n;
+}
+
+// Função auxiliar para trazer mais dados para o buffer; retorna 0 no fim da entrada
+static int refill(InputBuffer* in) {
+    if (in->eof) {
+        return 0;
+    }
+    if (in->data == NULL) {
+        in->data = (char*)mem_alloc(in->allocator, MEM_INPUT, INPUT_BUFFER_SIZE);
+        if (in->data == NULL) {
+            in->eof = 1;
+            return 0;
+        }
+        in->capacity = INPUT_BUFFER_SIZE;
+    }
+
+    // Move os dados pendentes para o início do buffer
+    if (in->start > 0) {
+        memmove(in->data, in->data + in->start, in->end - in->start);
+        in->end -= in->start;
+        in->scanned -= in->start;
+        in->start = 0;
+    }
+
+    // Uma linha maior que o buffer: dobra a capacidade (um byte fica livre para o '\0')
+    if (in->end + 1 >= in->capacity) {
+        char* data = (char*)mem_realloc(in->allocator, MEM_INPUT, in->data, in->capacity * 2);
+        if (data == NULL) {
+            in->eof = 1;
+            return 0;
+        }
+        in->data = data;
+        in->capacity *= 2;
+    }
+
+    // A leitura pode bloquear: o que já foi impresso (um prompt, por exemplo) precisa aparecer antes
+    if (in->output != NULL) {
+        output_flush(in->output);
+    }
+
+    ssize_t n = read_retry(in->fd, in->data + in->end, in->capacity - in->end - 1);
+    if (n <= 0) {
+        in->eof = 1;
+        return 0;
+    }
+    in->end += (size_t)n;
+    return 1;
+}
+
+// Função para ler a próxima linha sem copiá-la
+int input_next_line(InputBuffer* in, const char** line, size_t* length) {
+    if (in->data == NULL && !refill(in)) {
+        return 0;
+    }
+    for (;;) {
+        char* newline = (char*)memchr(in->data + in->scanned, '\n', in->end - in->scanned);
+        if (newline != NULL) {
+            size_t len = (size_t)(newline - (in->data + in->start));
+            *newline = '\0';
+            if (len > 0 && in->data[in->start + len - 1] == '\r') {
+                in->data[in->start + --len] = '\0';
+            }
+            *line = in->data + in->start;
+            *length = len;
+            in->start = in->scanned = (size_t)(newline - in->data) + 1;
+            return 1;
+        }
+        in->scanned = in->end;
+        if (!refill(in)) {
+            if (in->data == NULL || in->start == in->end) {
+                return 0;
+            }
+            // Última linha sem '\n'
+            in->data[in->end] = '\0';
+            *line = in->data + in->start;
+            *length = in->end - in->start;
+            in->start = in->scanned = in->end;
+            return 1;
+        }
+    }
+}
+
+// Função auxiliar para garantir espaço em uma string em crescimento
+static int reserve(Allocator* allocator, char** data, size_t* capacity, size_t needed) {
+    if (needed <= *capacity) {
+        return 1;
+    }
+    size_t new_capacity = *capacity == 0 ? 256 : *capacity;
+    while (new_capacity < needed) {
+        new_capacity *= 2;
+    }
+    char* grown = (char*)mem_realloc(allocator, MEM_INPUT, *data, new_capacity);
+    if (grown == NULL) {
+        return 0;
+    }
+    *data = grown;
+    *capacity = new_capacity;
+    return 1;
+}
+
+// Função para ler várias linhas (ou toda a entrada restante) para uma string
+char* input_read_lines(InputBuffer* in, long max_lines, size_t* length) {
+    char* result = NULL;
+    size_t size = 0;
+    size_t capacity = 0;
+
+    if (max_lines <= 0) {
+        // Toda a entrada: copia o que já está no buffer e lê o resto direto no resultado
+        if (in->data == NULL && !refill(in)) {
+            return NULL;
+        }
+        size_t pending = in->end - in->start;
+        if (pending == 0 && in->eof) {
+            return NULL;
+        }
+        if (!reserve(in->allocator, &result, &capacity, pending + INPUT_BUFFER_SIZE)) {
+            return NULL;
+        }
+        memcpy(result, in->data + in->start, pending);
+        size = pending;
+        in->start = in->end = in->scanned = 0;
+        if (in->output != NULL) {
+            output_flush(in->output);
+        }
+        while (!in->eof) {
+            if (!reserve(in->allocator, &result, &capacity, size + INPUT_BUFFER_SIZE)) {
+                mem_free(in->allocator, result);
+                return NULL;
+            }
+            ssize_t n = read_retry(in->fd, result + size, capacity - size - 1);
+            if (n <= 0) {
+                in->eof = 1;
+                break;
+            }
+            size += (size_t)n;
+        }
+        if (size > 0 && result[size - 1] == '\n') {
+            size--;
+        }
+    } else {
+        const char* line;
+        size_t line_length;
+        long count = 0;
+        while (count < max_lines && input_next_line(in, &line, &line_length)) {
+            size_t separator = count > 0 ? 1 : 0;
+            if (!reserve(in->allocator, &result, &capacity, size + separator + line_length + 1)) {
+                mem_free(in->allocator, result);
+                return NULL;
+            }
+            if (separator) {
+                result[size++] = '\n';
+            }
+            memcpy(result + size, line, line_length);
+            size += line_length;
+            count++;
+        }
+        if (count == 0) {
+            return NULL;
+        }
+    }
+
+    result[size] = '\0';
+    *length = size;
+    return result;
+}
@@ -3,49 +3,54 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdarg.h>
+#include <limits.h>
+#include <unistd.h>
 #include "interpreter.h"
+#include "iterator.h"
+#include "dict.h"
+#include "binary.h"
+#include "memo.h"
 
-// Implementação simples de strdup para compatibilidade C99
-char* strdup_c99(const char* s) {
-    size_t len = strlen(s) + 1;
-    char* new_s = (char*)malloc(len);
-    if (new_s == NULL) {
-        return NULL;
-    }
-    return (char*)memcpy(new_s, s, len);
+// Implementação simples de strdup sobre o alocador da instância
+static char* strdup_c99(Allocator* allocator, MemTag tag, const char* s) {
+    return mem_strndup(allocator, tag, s, strlen(s));
 }
 
 // Função para inicializar a tabela de símbolos
-void init_symbol_table(SymbolTable* table) {
+void init_symbol_table(SymbolTable* table, Allocator* allocator) {
     table->head = NULL;
+    table->allocator = allocator;
 }
 
 // Função para adicionar um símbolo à tabela
-void add_symbol(SymbolTable* table, const char* name, Value value) {
+int add_symbol(SymbolTable* table, const char* name, Value value) {
     // Primeiro, verifica se o símbolo já existe para atualizar
     SymbolTableEntry* current = table->head;
     while (current != NULL) {
         if (strcmp(current->name, name) == 0) {
             // Libera o valor antigo se for string para evitar vazamento de memória
-            if (current->value.type == VALUE_STRING) {
-                free(current->value.data.string_val);
-            }
+            free_value(table->allocator, current->value);
             current->value = value;
-            return;
+            return 1;
         }
         current = current->next;
     }
 
     // Se não existe, adiciona um novo
-    SymbolTableEntry* new_entry = (SymbolTableEntry*)malloc(sizeof(SymbolTableEntry));
+    SymbolTableEntry* new_entry = (SymbolTableEntry*)mem_alloc(table->allocator, MEM_SYMBOLS, sizeof(SymbolTableEntry));
     if (new_entry == NULL) {
-        fprintf(stderr, "Erro: Falha na alocação de memória para SymbolTableEntry.\n");
-        exit(1);
+        return 0;
+    }
+    new_entry->name = strdup_c99(table->allocator, MEM_SYMBOLS, name);
+    if (new_entry->name == NULL) {
+        mem_free(table->allocator, new_entry);
+        return 0;
     }
-    new_entry->name = strdup_c99(name);
     new_entry->value = value;
     new_entry->next = table->head;
     table->head = new_entry;
+    return 1;
 }
 
 // Função para buscar um símbolo na tabela
@@ -65,26 +70,1082 @@ void free_symbol_table(SymbolTable* table) {
     SymbolTableEntry* current = table->head;
     while (current != NULL) {
         SymbolTableEntry* next = current->next;
-        if (current->value.type == VALUE_STRING) {
-            free(current->value.data.string_val);
-        }
-        free(current->name);
-        free(current);
+        free_value(table->allocator, current->value);
+        mem_free(table->allocator, current->name);
+        mem_free(table->allocator, current);
         current = next;
     }
     table->head = NULL;
 }
 
 // Função para liberar um valor
-void free_value(Value value) {
+void free_value(Allocator* allocator, Value value) {
     if (value.type == VALUE_STRING) {
-        free(value.data.string_val);
+        mem_free(allocator, value.data.string_val);
+    } else if (value.type == VALUE_LIST) {
+        list_release(allocator, (List*)value.data.list_val);
+    } else if (value.type == VALUE_DICT) {
+        dict_release(allocator, (Dict*)value.data.dict_val);
     }
-    // Adicionar lógica para liberar listas e dicionários quando implementados
 }
 
-// Função principal para interpretar a AST
-Value interpret(ASTNode* node, SymbolTable* global_table) {
+// Função para copiar um valor
+int copy_value(Allocator* allocator, Value value, Value* copy) {
+    *copy = value;
+    if (value.type == VALUE_STRING) {
+        copy->data.string_val = strdup_c99(allocator, MEM_INTERPRETER, value.data.string_val);
+        return copy->data.string_val != NULL;
+    }
+    if (value.type == VALUE_LIST) {
+        list_retain((List*)value.data.list_val);
+    } else if (value.type == VALUE_DICT) {
+        dict_retain((Dict*)value.data.dict_val);
+    }
+    return 1;
+}
+
+// Função para inicializar o interpretador
+void interpreter_init(Interpreter* interp, Allocator* allocator) {
+    interp->allocator = allocator;
+    init_symbol_table(&interp->globals, allocator);
+    interp->locals = NULL;
+    init_symbol_table(&interp->stage_vars, allocator);
+    interp->functions = NULL;
+    interp->num_functions = 0;
+    interp->function_capacity = 0;
+    interp->memo_size = MEMO_DEFAULT_SIZE;
+    interp->call_depth = 0;
+    interp->declarations = 0;
+    interp->file = NULL;
+    interp->returning = 0;
+    interp->return_value.type = VALUE_NULL;
+    interp->import_failed = 0;
+    error_init(&interp->error);
+    output_init(&interp->output, STDOUT_FILENO, allocator);
+    input_init(&interp->input, STDIN_FILENO, allocator, &interp->output);
+    interp->modules = NULL;
+    interp->profiler = NULL;
+    interp->shadow = NULL;
+    interp->trace = NULL;
+}
+
+// Função para liberar o estado do interpretador
+void interpreter_free(Interpreter* interp) {
+    output_free(&interp->output);
+    input_free(&interp->input);
+    free_symbol_table(&interp->globals);
+    for (int i = 0; i < interp->num_functions; i++) {
+        if (interp->functions[i].memo != NULL) {
+            memo_free(interp->functions[i].memo);
+            mem_free(interp->allocator, interp->functions[i].memo);
+        }
+    }
+    mem_free(interp->allocator, interp->functions);
+    interp->functions = NULL;
+    interp->num_functions = 0;
+}
+
+// Função auxiliar para registrar um erro de execução na posição do nó
+static Value runtime_error(Interpreter* interp, ASTNode* node, const char* format, ...) {
+    char message[RODY_ERROR_MAX];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(message, sizeof(message), format, args);
+    va_end(args);
+    error_set(&interp->error, node->token.line, node->token.column,
+              "Erro de execução na linha %d, coluna %d: %s", node->token.line, node->token.column, message);
+
+    Value result;
+    result.type = VALUE_NULL;
+    return result;
+}
+
+// Função auxiliar para obter a tabela onde as variáveis são criadas: a da
+// chamada em andamento ou, fora de funções, a global
+static SymbolTable* scope(Interpreter* interp) {
+    return interp->locals != NULL ? interp->locals : &interp->globals;
+}
+
+// Função auxiliar para escrever um valor no buffer de saída; 0 se o tipo não é suportado
+static int print_value(OutputBuffer* out, Value value) {
+    switch (value.type) {
+        case VALUE_INTEGER: output_int(out, value.data.int_val); return 1;
+        case VALUE_FLOAT: output_float(out, value.data.float_val); return 1;
+        case VALUE_STRING: output_write(out, value.data.string_val, strlen(value.data.string_val)); return 1;
+        case VALUE_NULL: return 1;
+        case VALUE_LIST: {
+            List* list = (List*)value.data.list_val;
+            output_char(out, '[');
+            for (int i = 0; i < list->count; i++) {
+                if (i > 0) {
+                    output_write(out, ", ", 2);
+                }
+                if (!print_value(out, list_get(list, i))) {
+                    return 0;
+                }
+            }
+            output_char(out, ']');
+            return 1;
+        }
+        case VALUE_DICT: {
+            // As chaves saem na ordem da tabela hash
+            Dict* dict = (Dict*)value.data.dict_val;
+            output_char(out, '{');
+            int printed = 0;
+            for (int i = 0; i < dict->capacity; i++) {
+                DictEntry* entry = &dict->entries[i];
+                if (entry->key == NULL) {
+                    continue;
+                }
+                if (printed++ > 0) {
+                    output_write(out, ", ", 2);
+                }
+                output_write(out, entry->key, strlen(entry->key));
+                output_write(out, ": ", 2);
+                if (!print_value(out, entry->value)) {
+                    return 0;
+                }
+            }
+            output_char(out, '}');
+            return 1;
+        }
+        default:
+            return 0;
+    }
+}
+
+// Função auxiliar para escrever um item de print no buffer de saída
+static void print_item(Interpreter* interp, ASTNode* item) {
+    OutputBuffer* out = &interp->output;
+    if (item->type == NODE_PRINT_FORMAT) {
+        switch (item->token.type) {
+            case TOKEN_BR: output_newline(out); break;
+            case TOKEN_TAB: output_char(out, '\t'); break;
+            case TOKEN_COLOR: output_color(out, output_color_index(item->children[0]->token.lexeme)); break;
+            default: break;
+        }
+        return;
+    }
+
+    Value value = interpret(interp, item);
+    if (!print_value(out, value)) {
+        runtime_error(interp, item, "Tipo de valor não suportado pelo print.");
+    }
+    free_value(interp->allocator, value);
+}
+
+// Função auxiliar para converter uma linha em int sem passar por strtol
+// (caminho rápido do get int). Retorna 0 se a linha não for um inteiro válido.
+static int parse_int_line(const char* s, size_t length, int* out) {
+    size_t i = 0;
+    while (i < length && (s[i] == ' ' || s[i] == '\t')) {
+        i++;
+    }
+    int negative = 0;
+    if (i < length && (s[i] == '-' || s[i] == '+')) {
+        negative = s[i] == '-';
+        i++;
+    }
+    size_t digits_start = i;
+    long long value = 0;
+    while (i < length && (unsigned char)(s[i] - '0') <= 9) {
+        value = value * 10 + (s[i] - '0');
+        if (value > (long long)INT_MAX + 1) {
+            return 0;
+        }
+        i++;
+    }
+    if (i == digits_start) {
+        return 0;
+    }
+    while (i < length && (s[i] == ' ' || s[i] == '\t')) {
+        i++;
+    }
+    if (i != length || (!negative && value > INT_MAX)) {
+        return 0;
+    }
+    *out = (int)(negative ? -value : value);
+    return 1;
+}
+
+// Função auxiliar para executar um get: lê uma linha (ou um lote de linhas)
+// e guarda o valor na variável. No fim da entrada a variável recebe nulo.
+static Value get_statement(Interpreter* interp, ASTNode* node) {
+    Value value;
+    value.type = VALUE_NULL;
+    const char* name = node->children[0]->token.lexeme;
+
+    if (node->num_children > 1 || (node->flags & NODE_FLAG_GET_ALL)) {
+        // Lote: N linhas ou, com '*', toda a entrada restante (count 0)
+        long count = 0;
+        if (!(node->flags & NODE_FLAG_GET_ALL)) {
+            ASTNode* count_node = node->children[1];
+            Value n = interpret(interp, count_node);
+            if (interp->error.has_error) {
+                return n;
+            }
+            if (n.type != VALUE_INTEGER || n.data.int_val <= 0) {
+                free_value(interp->allocator, n);
+                return runtime_error(interp, count_node, "A quantidade de linhas do get deve ser um inteiro positivo.");
+            }
+            count = n.data.int_val;
+        }
+        size_t length;
+        char* text = input_read_lines(&interp->input, count, &length);
+        if (text != NULL) {
+            value.type = VALUE_STRING;
+            value.data.string_val = text;
+        }
+    } else {
+        // A linha aponta para dentro do buffer de entrada; números são convertidos ali mesmo
+        const char* line;
+        size_t length;
+        if (input_next_line(&interp->input, &line, &length)) {
+            switch (node->token.type) {
+                case TOKEN_TYPE_INT:
+                    if (!parse_int_line(line, length, &value.data.int_val)) {
+                        return runtime_error(interp, node, "Entrada inválida para int: '%s'", line);
+                    }
+                    value.type = VALUE_INTEGER;
+                    break;
+                case TOKEN_TYPE_FLOAT: {
+                    char* end;
+                    double parsed = strtod(line, &end);
+                    while (*end == ' ' || *end == '\t') {
+                        end++;
+                    }
+                    if (end == line || *end != '\0') {
+                        return runtime_error(interp, node, "Entrada inválida para float: '%s'", line);
+                    }
+                    value.type = VALUE_FLOAT;
+                    value.data.float_val = (float)parsed;
+                    break;
+                }
+                default:
+                    // Strings precisam de cópia: o buffer é reaproveitado na próxima leitura
+                    value.data.string_val = mem_strndup(interp->allocator, MEM_INTERPRETER, line, length);
+                    if (value.data.string_val == NULL) {
+                        return runtime_error(interp, node, "Falha na alocação de memória para string.");
+                    }
+                    value.type = VALUE_STRING;
+                    break;
+            }
+        }
+    }
+
+    if (!add_symbol(scope(interp), name, value)) {
+        free_value(interp->allocator, value);
+        return runtime_error(interp, node, "Falha na alocação de memória para variável.");
+    }
+    Value result;
+    result.type = VALUE_NULL;
+    return result;
+}
+
+// Função auxiliar para trocar o módulo em execução; devolve o anterior.
+// O profiler é avisado só quando o arquivo muda de fato.
+static const char* enter_file(Interpreter* interp, const char* file) {
+    const char* previous = interp->file;
+    if (file != previous) {
+        interp->file = file;
+        if (RODY_UNLIKELY(interp->profiler != NULL)) {
+            profiler_set_file(interp->profiler, file);
+        }
+    }
+    return previous;
+}
+
+// Função auxiliar para executar um import: o módulo já foi analisado (em
+// paralelo, antes da execução) e roda uma única vez, no escopo global.
+static Value import_module(Interpreter* interp, ASTNode* node) {
+    Value result;
+    result.type = VALUE_NULL;
+    if (interp->modules == NULL) {
+        return runtime_error(interp, node, "Importação não disponível nesta instância.");
+    }
+    // Dentro de um módulo (ou de uma função declarada nele), o import é relativo ao módulo
+    Module* module = modules_get(interp->modules, interp->file, node->token.type, node->token.lexeme);
+    if (module == NULL) {
+        return runtime_error(interp, node, "Não foi possível resolver o módulo '%s'.", node->token.lexeme);
+    }
+    // Erros de leitura e análise do módulo só aparecem quando o import executa
+    if (module->error.has_error) {
+        error_set(&interp->error, module->error.line, module->error.column, "%s", module->error.message);
+        interp->import_failed = 1;
+        return result;
+    }
+    if (module->executed) {
+        return result;
+    }
+    // Um segundo import do mesmo módulo não o executa de novo. Imports
+    // circulares nem chegam aqui: modules_link os rejeita antes da execução.
+    module->executed = 1;
+    SymbolTable* locals = interp->locals;
+    SymbolTableEntry* stage_vars = interp->stage_vars.head;
+    interp->locals = NULL;
+    interp->stage_vars.head = NULL;
+    const char* file = enter_file(interp, module->path);
+    free_value(interp->allocator, interpret(interp, module->ast));
+    enter_file(interp, file);
+    interp->stage_vars.head = stage_vars;
+    interp->locals = locals;
+    return result;
+}
+
+// Função auxiliar para obter a posição de uma variável na tabela, criando-a
+// se preciso. A posição é estável: entradas só são liberadas com a tabela.
+static Value* symbol_slot(Interpreter* interp, ASTNode* name) {
+    Value* slot = get_symbol(scope(interp), name->token.lexeme);
+    if (slot == NULL) {
+        Value null_value;
+        null_value.type = VALUE_NULL;
+        if (!add_symbol(scope(interp), name->token.lexeme, null_value)) {
+            runtime_error(interp, name, "Falha na alocação de memória para variável.");
+            return NULL;
+        }
+        slot = get_symbol(scope(interp), name->token.lexeme);
+    }
+    return slot;
+}
+
+// Função auxiliar para decidir se um valor é verdadeiro (filter)
+static int is_true(Value value) {
+    switch (value.type) {
+        case VALUE_INTEGER: return value.data.int_val != 0;
+        case VALUE_FLOAT: return value.data.float_val != 0.0f;
+        case VALUE_STRING: return value.data.string_val[0] != '\0';
+        case VALUE_LIST: return ((List*)value.data.list_val)->count > 0;
+        case VALUE_DICT: return ((Dict*)value.data.dict_val)->count > 0;
+        default: return 0;
+    }
+}
+
+// Passada única sobre uma fonte (intervalo ou lista) com os estágios de um
+// pipeline aplicados elemento a elemento
+typedef struct {
+    ASTNode* node; // Intervalo, lista ou pipeline (para as mensagens de erro)
+    Iterator source;
+    ASTNode** stages;
+    int num_stages;
+    SymbolTableEntry* params; // Parâmetro de cada estágio, ligado só enquanto ele roda
+} Pass;
+
+// Função auxiliar para abrir uma passada; retorna 0 em caso de erro
+static int open_pass(Interpreter* interp, ASTNode* node, Pass* pass) {
+    ASTNode* source = node;
+    pass->node = node;
+    pass->stages = NULL;
+    pass->num_stages = 0;
+    pass->params = NULL;
+    if (node->type == NODE_PIPELINE) {
+        source = node->children[0];
+        pass->stages = node->children + 1;
+        pass->num_stages = node->num_children - 1;
+    }
+
+    if (source->type == NODE_RANGE) {
+        // Intervalo: só um contador, nenhuma lista é criada
+        Value start = interpret(interp, source->children[0]);
+        Value end = interpret(interp, source->children[1]);
+        if (interp->error.has_error || start.type != VALUE_INTEGER || end.type != VALUE_INTEGER) {
+            free_value(interp->allocator, start);
+            free_value(interp->allocator, end);
+            runtime_error(interp, source, "Os limites do intervalo devem ser inteiros.");
+            return 0;
+        }
+        iterator_range(&pass->source, start.data.int_val, end.data.int_val);
+    } else {
+        Value value = interpret(interp, source);
+        if (interp->error.has_error) {
+            free_value(interp->allocator, value);
+            return 0;
+        }
+        if (value.type != VALUE_LIST) {
+            free_value(interp->allocator, value);
+            runtime_error(interp, source, "Valor não iterável.");
+            return 0;
+        }
+        iterator_list(&pass->source, interp->allocator, (List*)value.data.list_val);
+        free_value(interp->allocator, value); // O iterador guarda a própria referência
+    }
+
+    if (pass->num_stages > 0) {
+        pass->params = (SymbolTableEntry*)mem_alloc(interp->allocator, MEM_INTERPRETER,
+                                                    pass->num_stages * sizeof(SymbolTableEntry));
+        if (pass->params == NULL) {
+            iterator_close(&pass->source);
+            runtime_error(interp, node, "Falha na alocação de memória para o pipeline.");
+            return 0;
+        }
+        for (int i = 0; i < pass->num_stages; i++) {
+            pass->params[i].name = pass->stages[i]->children[0]->token.lexeme;
+            pass->params[i].value.type = VALUE_NULL;
+            pass->params[i].next = NULL;
+        }
+    }
+    return 1;
+}
+
+// Função auxiliar para obter o próximo elemento que passa por todos os
+// estágios. Retorna 0 no fim da fonte ou em caso de erro.
+static int pass_next(Interpreter* interp, Pass* pass, Value* element) {
+    Value current;
+    while (iterator_next(&pass->source, &current)) {
+        int keep = 1;
+        for (int i = 0; i < pass->num_stages && keep; i++) {
+            ASTNode* stage = pass->stages[i];
+            SymbolTableEntry* param = &pass->params[i];
+            // O elemento pertence ao parâmetro só enquanto o estágio roda: uma
+            // variável de mesmo nome fica escondida, mas não é alterada
+            param->value = current;
+            param->next = interp->stage_vars.head;
+            interp->stage_vars.head = param;
+            Value result = interpret(interp, stage->children[1]);
+            interp->stage_vars.head = param->next;
+            if (interp->error.has_error) {
+                free_value(interp->allocator, param->value);
+                free_value(interp->allocator, result);
+                return 0;
+            }
+            if (stage->type == NODE_MAP) {
+                free_value(interp->allocator, param->value);
+                current = result;
+                continue;
+            }
+            keep = is_true(result);
+            free_value(interp->allocator, result);
+            if (keep) {
+                current = param->value;
+            } else {
+                free_value(interp->allocator, param->value);
+            }
+        }
+        if (keep) {
+            *element = current;
+            return 1;
+        }
+    }
+    if (pass->source.failed) {
+        runtime_error(interp, pass->node, "Falha na alocação de memória para o pipeline.");
+    }
+    return 0;
+}
+
+// Função auxiliar para fechar uma passada
+static void close_pass(Interpreter* interp, Pass* pass) {
+    iterator_close(&pass->source);
+    mem_free(interp->allocator, pass->params);
+}
+
+// Função auxiliar para materializar um intervalo ou pipeline numa lista
+static Value collect_pass(Interpreter* interp, ASTNode* node) {
+    Value result;
+    result.type = VALUE_NULL;
+    Pass pass;
+    if (!open_pass(interp, node, &pass)) {
+        return result;
+    }
+    List* list = list_new(interp->allocator, 0);
+    if (list == NULL) {
+        close_pass(interp, &pass);
+        return runtime_error(interp, node, "Falha na alocação de memória para lista.");
+    }
+    Value element;
+    while (pass_next(interp, &pass, &element)) {
+        if (!list_append(interp->allocator, list, element)) {
+            free_value(interp->allocator, element);
+            runtime_error(interp, node, "Falha na alocação de memória para lista.");
+            break;
+        }
+    }
+    close_pass(interp, &pass);
+    result.type = VALUE_LIST;
+    result.data.list_val = list;
+    return result;
+}
+
+// Função auxiliar para executar um for: fonte e estágios numa única passada
+static Value for_statement(Interpreter* interp, ASTNode* node) {
+    Value result;
+    result.type = VALUE_NULL;
+    Value* variable = symbol_slot(interp, node->children[0]);
+    Pass pass;
+    if (variable == NULL || !open_pass(interp, node->children[1], &pass)) {
+        return result;
+    }
+    Value element;
+    while (!interp->error.has_error && !interp->returning && pass_next(interp, &pass, &element)) {
+        free_value(interp->allocator, *variable);
+        *variable = element;
+        free_value(interp->allocator, interpret(interp, node->children[2]));
+    }
+    close_pass(interp, &pass);
+    return result;
+}
+
+// Função auxiliar para executar um loop: repete o bloco N vezes
+static Value loop_statement(Interpreter* interp, ASTNode* node) {
+    Value count = interpret(interp, node->children[0]);
+    if (interp->error.has_error) {
+        return count;
+    }
+    if (count.type != VALUE_INTEGER) {
+        free_value(interp->allocator, count);
+        return runtime_error(interp, node->children[0], "A quantidade de repetições do loop deve ser um inteiro.");
+    }
+    Iterator it;
+    iterator_range(&it, 0, count.data.int_val);
+    Value index;
+    while (!interp->error.has_error && !interp->returning && iterator_next(&it, &index)) {
+        free_value(interp->allocator, interpret(interp, node->children[1]));
+    }
+    iterator_close(&it);
+    Value result;
+    result.type = VALUE_NULL;
+    return result;
+}
+
+// Função auxiliar para comparar dois valores (resultado 0 ou 1)
+static Value compare_values(Interpreter* interp, ASTNode* node, Value left, Value right) {
+    int order;
+    if (left.type == VALUE_STRING && right.type == VALUE_STRING) {
+        order = strcmp(left.data.string_val, right.data.string_val);
+    } else if ((left.type == VALUE_INTEGER || left.type == VALUE_FLOAT) &&
+               (right.type == VALUE_INTEGER || right.type == VALUE_FLOAT)) {
+        if (left.type == VALUE_INTEGER && right.type == VALUE_INTEGER) {
+            order = (left.data.int_val > right.data.int_val) - (left.data.int_val < right.data.int_val);
+        } else {
+            double a = left.type == VALUE_INTEGER ? left.data.int_val : left.data.float_val;
+            double b = right.type == VALUE_INTEGER ? right.data.int_val : right.data.float_val;
+            order = (a > b) - (a < b);
+        }
+    } else {
+        return runtime_error(interp, node, "Comparação inválida entre tipos.");
+    }
+
+    Value result;
+    result.type = VALUE_INTEGER;
+    switch (node->token.type) {
+        case TOKEN_EQ: result.data.int_val = order == 0; break;
+        case TOKEN_NEQ: result.data.int_val = order != 0; break;
+        case TOKEN_LT: result.data.int_val = order < 0; break;
+        case TOKEN_GT: result.data.int_val = order > 0; break;
+        case TOKEN_LE: result.data.int_val = order <= 0; break;
+        default: result.data.int_val = order >= 0; break;
+    }
+    return result;
+}
+
+// Função auxiliar para montar um dicionário literal (filhos alternam chave e valor)
+static Value dict_literal(Interpreter* interp, ASTNode* node) {
+    Value result;
+    result.type = VALUE_NULL;
+    Dict* dict = dict_new(interp->allocator);
+    if (dict == NULL) {
+        return runtime_error(interp, node, "Falha na alocação de memória para dicionário.");
+    }
+    result.type = VALUE_DICT;
+    result.data.dict_val = dict;
+    for (int i = 0; i + 1 < node->num_children && !interp->error.has_error; i += 2) {
+        Value key = interpret(interp, node->children[i]);
+        if (interp->error.has_error) {
+            break;
+        }
+        if (key.type != VALUE_STRING) {
+            free_value(interp->allocator, key);
+            runtime_error(interp, node->children[i], "Chaves de dicionário devem ser strings.");
+            break;
+        }
+        Value value = interpret(interp, node->children[i + 1]);
+        if (!interp->error.has_error && !dict_set(interp->allocator, dict, key.data.string_val, value)) {
+            free_value(interp->allocator, value);
+            runtime_error(interp, node, "Falha na alocação de memória para dicionário.");
+        }
+        free_value(interp->allocator, key);
+    }
+    if (interp->error.has_error) {
+        free_value(interp->allocator, result);
+        result.type = VALUE_NULL;
+    }
+    return result;
+}
+
+// Função auxiliar para avaliar valor[i]: posição de uma lista ou chave de um
+// dicionário (chave ausente produz null)
+static Value index_value(Interpreter* interp, ASTNode* node) {
+    Value result;
+    result.type = VALUE_NULL;
+    Value target = interpret(interp, node->children[0]);
+    if (interp->error.has_error) {
+        return target;
+    }
+    Value index = interpret(interp, node->children[1]);
+    if (interp->error.has_error) {
+        free_value(interp->allocator, target);
+        return index;
+    }
+
+    if (target.type == VALUE_LIST && index.type == VALUE_INTEGER) {
+        List* list = (List*)target.data.list_val;
+        if (index.data.int_val < 0 || index.data.int_val >= list->count) {
+            runtime_error(interp, node, "Índice %d fora dos limites (tamanho %d).", index.data.int_val, list->count);
+        } else if (!copy_value(interp->allocator, list_get(list, index.data.int_val), &result)) {
+            runtime_error(interp, node, "Falha na alocação de memória para string.");
+        }
+    } else if (target.type == VALUE_DICT && index.type == VALUE_STRING) {
+        const Value* found = dict_get((Dict*)target.data.dict_val, index.data.string_val);
+        if (found != NULL && !copy_value(interp->allocator, *found, &result)) {
+            runtime_error(interp, node, "Falha na alocação de memória para string.");
+        }
+    } else {
+        runtime_error(interp, node, "Acesso por índice requer lista[int] ou dicionário[string].");
+    }
+    // Copiado antes de soltar o contêiner: o item pode morar num arquivo mapeado
+    free_value(interp->allocator, target);
+    free_value(interp->allocator, index);
+    return result;
+}
+
+// Função auxiliar para executar save valor -> caminho
+static Value save_statement(Interpreter* interp, ASTNode* node) {
+    Value result;
+    result.type = VALUE_NULL;
+    Value value = interpret(interp, node->children[0]);
+    if (interp->error.has_error) {
+        return value;
+    }
+    Value path = interpret(interp, node->children[1]);
+    if (!interp->error.has_error) {
+        if (path.type != VALUE_STRING) {
+            runtime_error(interp, node, "O caminho do arquivo deve ser uma string.");
+        } else {
+            long long start_ns = interp->trace != NULL ? trace_now() : 0;
+            BinaryStatus status = binary_save(interp->allocator, value, path.data.string_val);
+            if (interp->trace != NULL) {
+                trace_span(interp->trace, "save", "io", start_ns, trace_now(), path.data.string_val);
+            }
+            if (status != BINARY_OK) {
+                runtime_error(interp, node, "Não foi possível salvar '%s': %s", path.data.string_val,
+                              binary_status_message(status));
+            }
+        }
+    }
+    free_value(interp->allocator, value);
+    free_value(interp->allocator, path);
+    return result;
+}
+
+// Função auxiliar para avaliar load caminho
+static Value load_expression(Interpreter* interp, ASTNode* node) {
+    Value result;
+    result.type = VALUE_NULL;
+    Value path = interpret(interp, node->children[0]);
+    if (interp->error.has_error) {
+        return path;
+    }
+    if (path.type != VALUE_STRING) {
+        free_value(interp->allocator, path);
+        return runtime_error(interp, node, "O caminho do arquivo deve ser uma string.");
+    }
+    long long start_ns = interp->trace != NULL ? trace_now() : 0;
+    BinaryStatus status = binary_load(interp->allocator, path.data.string_val, &result);
+    if (interp->trace != NULL) {
+        trace_span(interp->trace, "load", "io", start_ns, trace_now(), path.data.string_val);
+    }
+    if (status != BINARY_OK) {
+        runtime_error(interp, node, "Não foi possível carregar '%s': %s", path.data.string_val,
+                      binary_status_message(status));
+    }
+    free_value(interp->allocator, path);
+    return result;
+}
+
+// Função auxiliar para executar if/else
+static Value if_statement(Interpreter* interp, ASTNode* node) {
+    Value condition = interpret(interp, node->children[0]);
+    if (interp->error.has_error) {
+        return condition;
+    }
+    int taken = is_true(condition);
+    free_value(interp->allocator, condition);
+    Value result;
+    result.type = VALUE_NULL;
+    if (taken) {
+        free_value(interp->allocator, interpret(interp, node->children[1]));
+    } else if (node->num_children > 2) {
+        free_value(interp->allocator, interpret(interp, node->children[2]));
+    }
+    return result;
+}
+
+// Função auxiliar para buscar uma função declarada; NULL se não existe
+static Function* find_function(Interpreter* interp, const char* name) {
+    for (int i = 0; i < interp->num_functions; i++) {
+        if (strcmp(interp->functions[i].name, name) == 0) {
+            return &interp->functions[i];
+        }
+    }
+    return NULL;
+}
+
+// Quantidade de nomes acompanhados pela análise de pureza (acima disso a
+// função é tratada como impura)
+#define PURITY_MAX_NAMES 64
+
+// Nomes já ligados num ponto do corpo: parâmetros e variáveis locais atribuídas
+typedef struct {
+    const char* names[PURITY_MAX_NAMES];
+    int count;
+} PurityScope;
+
+// Função auxiliar para ligar um nome; 0 se não couber
+static int bind_name(PurityScope* names, const char* name) {
+    if (names->count == PURITY_MAX_NAMES) {
+        return 0;
+    }
+    names->names[names->count++] = name;
+    return 1;
+}
+
+// Função auxiliar para verificar se um nome já foi ligado
+static int is_bound(const PurityScope* names, const char* name) {
+    for (int i = 0; i < names->count; i++) {
+        if (strcmp(names->names[i], name) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Função auxiliar para decidir se um trecho de uma função é puro: sem entrada
+// e saída, sem ler variáveis que não sejam da própria chamada e só chamando
+// funções puras (ou ela mesma). Atribuições dentro de funções criam variáveis
+// locais, então não há escrita em globais a rastrear. Os nós são visitados na
+// ordem de execução; nomes ligados dentro de um bloco não valem depois dele,
+// já que o bloco pode não ter rodado.
+static int is_pure(Interpreter* interp, const ASTNode* fun, const ASTNode* node, PurityScope* names) {
+    int mark = names->count;
+    int pure = 1;
+    switch (node->type) {
+        case NODE_PRINT_STMT:
+        case NODE_GET_STMT:
+        case NODE_SYSTEM_CALL:
+        case NODE_FILE_READ:
+        case NODE_FILE_WRITE:
+        case NODE_FILE_APPEND:
+        case NODE_IMPORT:
+        case NODE_WAIT:
+        case NODE_FUN_DECL:
+            return 0;
+        case NODE_IDENTIFIER:
+            return is_bound(names, node->token.lexeme);
+        case NODE_ASSIGNMENT:
+            // O valor é avaliado antes de a variável existir
+            return is_pure(interp, fun, node->children[1], names) && bind_name(names, node->children[0]->token.lexeme);
+        case NODE_FOR_STMT:
+            pure = is_pure(interp, fun, node->children[1], names) && bind_name(names, node->children[0]->token.lexeme) &&
+                   is_pure(interp, fun, node->children[2], names);
+            names->count = mark;
+            return pure;
+        case NODE_MAP:
+        case NODE_FILTER:
+            pure = bind_name(names, node->children[0]->token.lexeme) && is_pure(interp, fun, node->children[1], names);
+            names->count = mark;
+            return pure;
+        case NODE_FUN_CALL:
+            if (strcmp(node->token.lexeme, fun->token.lexeme) != 0) {
+                Function* callee = find_function(interp, node->token.lexeme);
+                if (callee == NULL || !callee->pure) {
+                    return 0;
+                }
+            }
+            break;
+        default:
+            break;
+    }
+    for (int i = 0; i < node->num_children && pure; i++) {
+        pure = is_pure(interp, fun, node->children[i], names);
+    }
+    if (node->type == NODE_BLOCK) {
+        names->count = mark;
+    }
+    return pure;
+}
+
+// Função auxiliar para decidir a pureza de uma função com o que se sabe das demais
+static int function_is_pure(Interpreter* interp, const Function* function) {
+    const ASTNode* node = function->decl;
+    if (node->flags & NODE_FLAG_PURE) {
+        return 1;
+    }
+    PurityScope names;
+    names.count = 0;
+    for (int i = 0; i < function->num_params; i++) {
+        if (!bind_name(&names, node->children[i]->token.lexeme)) {
+            return 0;
+        }
+    }
+    return is_pure(interp, node, node->children[function->num_params], &names);
+}
+
+// Função auxiliar para dar um cache de resultados a uma função pura que ainda não tem
+// Retorna 0 se faltar memória
+static int attach_memo(Interpreter* interp, Function* function) {
+    if (!function->pure || function->memo != NULL || interp->memo_size <= 0) {
+        return 1;
+    }
+    function->memo = (MemoCache*)mem_alloc(interp->allocator, MEM_INTERPRETER, sizeof(MemoCache));
+    if (function->memo == NULL) {
+        return 0;
+    }
+    memo_init(function->memo, interp->allocator, interp->memo_size, function->num_params);
+    if (interp->profiler != NULL) {
+        profiler_add_memo(interp->profiler, function->name, &function->memo->stats);
+    }
+    return 1;
+}
+
+// Função auxiliar para trocar a definição de uma função já declarada. Quem a
+// chama pode mudar de pureza e os resultados guardados podem depender da
+// definição antiga, então todas as purezas são recalculadas e todos os caches
+// esvaziados (os caches continuam existindo: o profiler lê seus contadores).
+static Value redefine_function(Interpreter* interp, Function* function, ASTNode* node) {
+    function->name = node->token.lexeme;
+    function->decl = node;
+    function->num_params = node->num_children - 1;
+    function->file = interp->file;
+
+    // Maior ponto fixo: todas começam puras e são rebaixadas até estabilizar,
+    // o que também resolve funções que se chamam mutuamente
+    for (int i = 0; i < interp->num_functions; i++) {
+        interp->functions[i].pure = 1;
+    }
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+        for (int i = 0; i < interp->num_functions; i++) {
+            Function* other = &interp->functions[i];
+            if (other->pure && !function_is_pure(interp, other)) {
+                other->pure = 0;
+                changed = 1;
+            }
+        }
+    }
+
+    for (int i = 0; i < interp->num_functions; i++) {
+        Function* other = &interp->functions[i];
+        if (other->memo != NULL) {
+            memo_clear(other->memo, other->num_params);
+        }
+        if (!attach_memo(interp, other)) {
+            return runtime_error(interp, node, "Falha na alocação de memória para função.");
+        }
+    }
+    Value result;
+    result.type = VALUE_NULL;
+    return result;
+}
+
+// Função auxiliar para verificar se um trecho declara alguma função
+static int declares_function(const ASTNode* node) {
+    if (node->type == NODE_FUN_DECL) {
+        return 1;
+    }
+    for (int i = 0; i < node->num_children; i++) {
+        if (declares_function(node->children[i])) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Função auxiliar para registrar uma declaração fun. A pureza é decidida aqui
+// (e recalculada quando alguma função é redefinida); funções puras ganham um
+// cache de resultados.
+static Value declare_function(Interpreter* interp, ASTNode* node) {
+    Value result;
+    result.type = VALUE_NULL;
+    int num_params = node->num_children - 1;
+    if (num_params > RODY_MAX_PARAMS) {
+        return runtime_error(interp, node, "Funções aceitam no máximo %d parâmetros.", RODY_MAX_PARAMS);
+    }
+    // Uma declaração no corpo trocaria definições (e esvaziaria caches) no meio da chamada
+    if ((node->flags & NODE_FLAG_PURE) && declares_function(node->children[num_params])) {
+        return runtime_error(interp, node, "Uma função pure não pode declarar funções: '%s'", node->token.lexeme);
+    }
+    interp->declarations++;
+    Function* existing = find_function(interp, node->token.lexeme);
+    if (existing != NULL) {
+        return redefine_function(interp, existing, node);
+    }
+    if (interp->num_functions == interp->function_capacity) {
+        int capacity = interp->function_capacity == 0 ? 8 : interp->function_capacity * 2;
+        Function* functions = (Function*)mem_realloc(interp->allocator, MEM_INTERPRETER, interp->functions,
+                                                     capacity * sizeof(Function));
+        if (functions == NULL) {
+            return runtime_error(interp, node, "Falha na alocação de memória para função.");
+        }
+        interp->functions = functions;
+        interp->function_capacity = capacity;
+    }
+
+    Function* function = &interp->functions[interp->num_functions];
+    function->name = node->token.lexeme;
+    function->decl = node;
+    function->num_params = num_params;
+    function->memo = NULL;
+    function->file = interp->file;
+    function->pure = function_is_pure(interp, function);
+    if (!attach_memo(interp, function)) {
+        return runtime_error(interp, node, "Falha na alocação de memória para função.");
+    }
+    interp->num_functions++;
+    return result;
+}
+
+// Função auxiliar para executar um return: o valor fica guardado até a
+// chamada terminar, e os blocos e laços param de executar
+static Value return_statement(Interpreter* interp, ASTNode* node) {
+    Value result;
+    result.type = VALUE_NULL;
+    if (interp->locals == NULL) {
+        return runtime_error(interp, node, "return fora de uma função.");
+    }
+    if (node->num_children > 0) {
+        result = interpret(interp, node->children[0]);
+        if (interp->error.has_error) {
+            return result;
+        }
+    }
+    interp->return_value = result;
+    interp->returning = 1;
+    result.type = VALUE_NULL;
+    return result;
+}
+
+// Função auxiliar para executar uma chamada. Funções puras consultam o cache
+// antes de executar o corpo e guardam o resultado depois.
+static Value call_function(Interpreter* interp, ASTNode* node) {
+    Value result;
+    result.type = VALUE_NULL;
+    Function* function = find_function(interp, node->token.lexeme);
+    if (function == NULL) {
+        return runtime_error(interp, node, "Função não definida: '%s'", node->token.lexeme);
+    }
+    if (node->num_children != function->num_params) {
+        return runtime_error(interp, node, "A função '%s' espera %d argumento(s), recebeu %d.", function->name,
+                             function->num_params, node->num_children);
+    }
+
+    int declarations = interp->declarations;
+    Value args[RODY_MAX_PARAMS];
+    int num_args = 0;
+    for (; num_args < node->num_children; num_args++) {
+        args[num_args] = interpret(interp, node->children[num_args]);
+        if (interp->error.has_error) {
+            num_args++;
+            break;
+        }
+    }
+    // Os argumentos podem ter declarado ou redefinido funções (movendo a tabela)
+    if (!interp->error.has_error && interp->declarations != declarations) {
+        function = find_function(interp, node->token.lexeme);
+        if (function->num_params != num_args) {
+            runtime_error(interp, node, "A função '%s' espera %d argumento(s), recebeu %d.", function->name,
+                          function->num_params, num_args);
+        }
+    }
+
+    // O intervalo registrado cobre a consulta ao cache e o corpo, não os argumentos
+    long long start_ns = interp->trace != NULL ? trace_now() : 0;
+
+    // Listas e dicionários não entram na chave; a chamada executa normalmente
+    // (uma função redefinida como impura mantém o cache, parado)
+    MemoCache* memo = !interp->error.has_error && function->pure ? function->memo : NULL;
+    declarations = interp->declarations;
+    unsigned int hash = 0;
+    if (memo != NULL && memo_can_key(args, num_args)) {
+        hash = memo_hash(args, num_args);
+        const Value* cached = memo_lookup(memo, args, hash);
+        if (cached != NULL) {
+            if (!copy_value(interp->allocator, *cached, &result)) {
+                runtime_error(interp, node, "Falha na alocação de memória para string.");
+            }
+            for (int i = 0; i < num_args; i++) {
+                free_value(interp->allocator, args[i]);
+            }
+            if (interp->trace != NULL) {
+                trace_span(interp->trace, "chamada", "execucao", start_ns, trace_now(), node->token.lexeme);
+            }
+            return result;
+        }
+    } else {
+        memo = NULL;
+    }
+
+    if (!interp->error.has_error && interp->call_depth >= RODY_MAX_CALL_DEPTH) {
+        runtime_error(interp, node, "Limite de %d chamadas aninhadas excedido.", RODY_MAX_CALL_DEPTH);
+    }
+    if (!interp->error.has_error) {
+        SymbolTable frame;
+        init_symbol_table(&frame, interp->allocator);
+        for (int i = 0; i < num_args && !interp->error.has_error; i++) {
+            Value param;
+            if (!copy_value(interp->allocator, args[i], &param)) {
+                runtime_error(interp, node, "Falha na alocação de memória para string.");
+            } else if (!add_symbol(&frame, function->decl->children[i]->token.lexeme, param)) {
+                free_value(interp->allocator, param);
+                runtime_error(interp, node, "Falha na alocação de memória para variável.");
+            }
+        }
+        if (!interp->error.has_error) {
+            // Parâmetros de estágios de quem chamou não são visíveis na função
+            SymbolTable* caller = interp->locals;
+            SymbolTableEntry* stage_vars = interp->stage_vars.head;
+            interp->locals = &frame;
+            interp->stage_vars.head = NULL;
+            interp->call_depth++;
+            const char* file = enter_file(interp, function->file);
+            if (RODY_UNLIKELY(interp->shadow != NULL)) {
+                shadow_push(interp->shadow, node); // Frame com o nome e a linha da chamada
+            }
+            free_value(interp->allocator, interpret(interp, function->decl->children[function->num_params]));
+            if (RODY_UNLIKELY(interp->shadow != NULL)) {
+                shadow_pop(interp->shadow);
+            }
+            enter_file(interp, file);
+            interp->call_depth--;
+            interp->stage_vars.head = stage_vars;
+            interp->locals = caller;
+        }
+        if (interp->returning) {
+            result = interp->return_value;
+            interp->return_value.type = VALUE_NULL;
+            interp->returning = 0;
+        }
+        free_symbol_table(&frame);
+    }
+
+    // Se o corpo (por uma função impura que ele chamou) declarou funções, os
+    // caches foram esvaziados e o resultado pode vir da definição antiga
+    if (!interp->error.has_error && memo != NULL && interp->declarations == declarations) {
+        memo_store(memo, args, hash, result); // Sem memória, só deixa de guardar
+    }
+    for (int i = 0; i < num_args; i++) {
+        free_value(interp->allocator, args[i]);
+    }
+    if (interp->error.has_error) {
+        free_value(interp->allocator, result);
+        result.type = VALUE_NULL;
+    }
+    if (interp->trace != NULL) {
+        trace_span(interp->trace, "chamada", "execucao", start_ns, trace_now(), node->token.lexeme);
+    }
+    return result;
+}
+
+// Função que avalia um nó (o despacho de interpret, sem as sondas)
+static Value evaluate(Interpreter* interp, ASTNode* node) {
     Value result;
     result.type = VALUE_NULL; // Valor padrão
 
@@ -94,10 +1155,101 @@ Value interpret(ASTNode* node, SymbolTable* global_table) {
 
     switch (node->type) {
         case NODE_PROGRAM:
-            for (int i = 0; i < node->num_children; i++) {
-                interpret(node->children[i], global_table);
+            // O valor do programa é o valor da última instrução
+            // Cada instrução de nível superior é um frame da pilha-sombra
+            for (int i = 0; i < node->num_children && !interp->error.has_error; i++) {
+                free_value(interp->allocator, result);
+                if (RODY_UNLIKELY(interp->shadow != NULL)) {
+                    shadow_push(interp->shadow, node->children[i]);
+                }
+                result = interpret(interp, node->children[i]);
+                if (RODY_UNLIKELY(interp->shadow != NULL)) {
+                    shadow_pop(interp->shadow);
+                }
+            }
+            break;
+        case NODE_PRINT_STMT:
+            for (int i = 0; i < node->num_children && !interp->error.has_error; i++) {
+                print_item(interp, node->children[i]);
+            }
+            break;
+        case NODE_GET_STMT:
+            return get_statement(interp, node);
+        case NODE_IMPORT:
+            return import_module(interp, node);
+        case NODE_IDENTIFIER: {
+            // Parâmetros de estágio escondem as variáveis da chamada, que escondem as globais
+            Value* stored = NULL;
+            if (interp->stage_vars.head != NULL) {
+                stored = get_symbol(&interp->stage_vars, node->token.lexeme);
+            }
+            if (stored == NULL && interp->locals != NULL) {
+                stored = get_symbol(interp->locals, node->token.lexeme);
+            }
+            if (stored == NULL) {
+                stored = get_symbol(&interp->globals, node->token.lexeme);
+            }
+            if (stored == NULL) {
+                return runtime_error(interp, node, "Variável não definida: '%s'", node->token.lexeme);
+            }
+            if (!copy_value(interp->allocator, *stored, &result)) {
+                return runtime_error(interp, node, "Falha na alocação de memória para string.");
+            }
+            break;
+        }
+        case NODE_ASSIGNMENT: {
+            Value value = interpret(interp, node->children[1]);
+            if (interp->error.has_error) {
+                return value;
+            }
+            if (!add_symbol(scope(interp), node->children[0]->token.lexeme, value)) {
+                free_value(interp->allocator, value);
+                return runtime_error(interp, node, "Falha na alocação de memória para variável.");
+            }
+            break;
+        }
+        case NODE_BLOCK:
+            for (int i = 0; i < node->num_children && !interp->error.has_error && !interp->returning; i++) {
+                free_value(interp->allocator, interpret(interp, node->children[i]));
             }
             break;
+        case NODE_LIST: {
+            List* list = list_new(interp->allocator, node->num_children);
+            if (list == NULL) {
+                return runtime_error(interp, node, "Falha na alocação de memória para lista.");
+            }
+            result.type = VALUE_LIST;
+            result.data.list_val = list;
+            for (int i = 0; i < node->num_children && !interp->error.has_error; i++) {
+                Value item = interpret(interp, node->children[i]);
+                list_append(interp->allocator, list, item); // A capacidade já foi reservada
+            }
+            break;
+        }
+        case NODE_DICT:
+            return dict_literal(interp, node);
+        case NODE_INDEX:
+            return index_value(interp, node);
+        case NODE_FILE_WRITE:
+            return save_statement(interp, node);
+        case NODE_FILE_READ:
+            return load_expression(interp, node);
+        case NODE_RANGE:
+        case NODE_PIPELINE:
+            // Fora de um for, o intervalo ou pipeline é materializado numa lista
+            return collect_pass(interp, node);
+        case NODE_FOR_STMT:
+            return for_statement(interp, node);
+        case NODE_IF_STMT:
+            return if_statement(interp, node);
+        case NODE_FUN_DECL:
+            return declare_function(interp, node);
+        case NODE_FUN_CALL:
+            return call_function(interp, node);
+        case NODE_RETURN_STMT:
+            return return_statement(interp, node);
+        case NODE_LOOP_STMT:
+            return loop_statement(interp, node);
         case NODE_INTEGER:
             result.type = VALUE_INTEGER;
             result.data.int_val = atoi(node->token.lexeme);
@@ -108,11 +1260,28 @@ Value interpret(ASTNode* node, SymbolTable* global_table) {
             break;
         case NODE_STRING:
             result.type = VALUE_STRING;
-            result.data.string_val = strdup_c99(node->token.lexeme);
+            result.data.string_val = strdup_c99(interp->allocator, MEM_INTERPRETER, node->token.lexeme);
+            if (result.data.string_val == NULL) {
+                return runtime_error(interp, node, "Falha na alocação de memória para string.");
+            }
             break;
         case NODE_BINARY_OP: {
-            Value left = interpret(node->children[0], global_table);
-            Value right = interpret(node->children[1], global_table);
+            Value left = interpret(interp, node->children[0]);
+            if (interp->error.has_error) {
+                return left;
+            }
+            Value right = interpret(interp, node->children[1]);
+            if (interp->error.has_error) {
+                free_value(interp->allocator, left);
+                return right;
+            }
+
+            if (node->token.type >= TOKEN_EQ && node->token.type <= TOKEN_GE) {
+                result = compare_values(interp, node, left, right);
+                free_value(interp->allocator, left);
+                free_value(interp->allocator, right);
+                return result;
+            }
 
             // Implementação de otimização de expressões (constant folding)
             if (left.type == VALUE_INTEGER && right.type == VALUE_INTEGER) {
@@ -123,14 +1292,12 @@ Value interpret(ASTNode* node, SymbolTable* global_table) {
                     case TOKEN_MULTIPLY: result.data.int_val = left.data.int_val * right.data.int_val; break;
                     case TOKEN_DIVIDE: 
                         if (right.data.int_val == 0) {
-                            fprintf(stderr, "Erro de execução: Divisão por zero.\n");
-                            exit(1);
+                            return runtime_error(interp, node, "Divisão por zero.");
                         }
                         result.data.int_val = left.data.int_val / right.data.int_val; 
                         break;
                     default:
-                        fprintf(stderr, "Erro de interpretação: Operador binário inteiro desconhecido: %d\n", node->token.type);
-                        exit(1);
+                        return runtime_error(interp, node, "Operador binário inteiro desconhecido: %d", node->token.type);
                 }
             } else if (left.type == VALUE_FLOAT && right.type == VALUE_FLOAT) {
                 result.type = VALUE_FLOAT;
@@ -140,14 +1307,12 @@ Value interpret(ASTNode* node, SymbolTable* global_table) {
                     case TOKEN_MULTIPLY: result.data.float_val = left.data.float_val * right.data.float_val; break;
                     case TOKEN_DIVIDE: 
                         if (right.data.float_val == 0.0) {
-                            fprintf(stderr, "Erro de execução: Divisão por zero.\n");
-                            exit(1);
+                            return runtime_error(interp, node, "Divisão por zero.");
                         }
                         result.data.float_val = left.data.float_val / right.data.float_val; 
                         break;
                     default:
-                        fprintf(stderr, "Erro de interpretação: Operador binário float desconhecido: %d\n", node->token.type);
-                        exit(1);
+                        return runtime_error(interp, node, "Operador binário float desconhecido: %d", node->token.type);
                 }
             } else if (left.type == VALUE_INTEGER && right.type == VALUE_FLOAT) {
                 result.type = VALUE_FLOAT;
@@ -157,14 +1322,12 @@ Value interpret(ASTNode* node, SymbolTable* global_table) {
                     case TOKEN_MULTIPLY: result.data.float_val = (float)left.data.int_val * right.data.float_val; break;
                     case TOKEN_DIVIDE: 
                         if (right.data.float_val == 0.0) {
-                            fprintf(stderr, "Erro de execução: Divisão por zero.\n");
-                            exit(1);
+                            return runtime_error(interp, node, "Divisão por zero.");
                         }
                         result.data.float_val = (float)left.data.int_val / right.data.float_val; 
                         break;
                     default:
-                        fprintf(stderr, "Erro de interpretação: Operador binário misto desconhecido: %d\n", node->token.type);
-                        exit(1);
+                        return runtime_error(interp, node, "Operador binário misto desconhecido: %d", node->token.type);
                 }
             } else if (left.type == VALUE_FLOAT && right.type == VALUE_INTEGER) {
                 result.type = VALUE_FLOAT;
@@ -174,27 +1337,40 @@ Value interpret(ASTNode* node, SymbolTable* global_table) {
                     case TOKEN_MULTIPLY: result.data.float_val = left.data.float_val * (float)right.data.int_val; break;
                     case TOKEN_DIVIDE: 
                         if (right.data.int_val == 0) {
-                            fprintf(stderr, "Erro de execução: Divisão por zero.\n");
-                            exit(1);
+                            return runtime_error(interp, node, "Divisão por zero.");
                         }
                         result.data.float_val = left.data.float_val / (float)right.data.int_val; 
                         break;
                     default:
-                        fprintf(stderr, "Erro de interpretação: Operador binário misto desconhecido: %d\n", node->token.type);
-                        exit(1);
+                        return runtime_error(interp, node, "Operador binário misto desconhecido: %d", node->token.type);
                 }
             } else {
-                fprintf(stderr, "Erro de interpretação: Operação binária inválida entre tipos.\n");
-                exit(1);
+                free_value(interp->allocator, left);
+                free_value(interp->allocator, right);
+                return runtime_error(interp, node, "Operação binária inválida entre tipos.");
             }
             break;
         }
         default:
-            fprintf(stderr, "Erro de interpretação: Tipo de nó AST desconhecido: %d\n", node->type);
-            exit(1);
+            return runtime_error(interp, node, "Tipo de nó AST desconhecido: %d", node->type);
     }
     return result;
 }
 
+// Função que avalia um nó com o profiler por instrumentação ligado
+// (a pilha-sombra só recebe chamadas e instruções de nível superior)
+static Value evaluate_probed(Interpreter* interp, ASTNode* node) {
+    profiler_enter(interp->profiler, node);
+    Value result = evaluate(interp, node);
+    profiler_exit(interp->profiler);
+    return result;
+}
 
-
+// Função principal para interpretar a AST
+Value interpret(Interpreter* interp, ASTNode* node) {
+    // Sonda de perfil: compilada sempre, mas fora do caminho quente quando desligada
+    if (RODY_UNLIKELY(interp->profiler != NULL) && node != NULL) {
+        return evaluate_probed(interp, node);
+    }
+    return evaluate(interp, node);
+}
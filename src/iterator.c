@@ -0,0 +1,136 @@
+
+/* iterator.c */
+
+#include <string.h>
+#include "iterator.h"
+#include "binary.h"
+
+// Função para criar uma lista vazia
+List* list_new(Allocator* allocator, int capacity) {
+    List* list = (List*)mem_alloc(allocator, MEM_INTERPRETER, sizeof(List));
+    if (list == NULL) {
+        return NULL;
+    }
+    list->refs = 1;
+    list->kind = LIST_VALUES;
+    list->raw = NULL;
+    list->image = NULL;
+    list->count = 0;
+    list->capacity = capacity > 0 ? capacity : 0;
+    list->items = NULL;
+    if (list->capacity > 0) {
+        list->items = (Value*)mem_alloc(allocator, MEM_INTERPRETER, list->capacity * sizeof(Value));
+        if (list->items == NULL) {
+            mem_free(allocator, list);
+            return NULL;
+        }
+    }
+    return list;
+}
+
+// Função para adicionar um valor ao fim da lista
+int list_append(Allocator* allocator, List* list, Value value) {
+    if (list->count == list->capacity) {
+        int capacity = list->capacity == 0 ? 8 : list->capacity * 2;
+        Value* items = (Value*)mem_realloc(allocator, MEM_INTERPRETER, list->items, capacity * sizeof(Value));
+        if (items == NULL) {
+            return 0;
+        }
+        list->items = items;
+        list->capacity = capacity;
+    }
+    list->items[list->count++] = value;
+    return 1;
+}
+
+// Função para tomar mais uma referência
+void list_retain(List* list) {
+    // Listas de um arquivo mapeado compartilham a contagem do arquivo
+    if (list->image != NULL) {
+        list->image->refs++;
+    } else {
+        list->refs++;
+    }
+}
+
+// Função para soltar uma referência; a lista é liberada na última
+void list_release(Allocator* allocator, List* list) {
+    if (list == NULL) {
+        return;
+    }
+    if (list->image != NULL) {
+        image_release(list->image);
+        return;
+    }
+    if (--list->refs > 0) {
+        return;
+    }
+    for (int i = 0; i < list->count; i++) {
+        free_value(allocator, list->items[i]);
+    }
+    mem_free(allocator, list->items);
+    mem_free(allocator, list);
+}
+
+// Função para ler o item index sem copiá-lo
+Value list_get(const List* list, int index) {
+    Value value;
+    switch (list->kind) {
+        case LIST_INTS:
+            value.type = VALUE_INTEGER;
+            value.data.int_val = ((const int*)list->raw)[index];
+            return value;
+        case LIST_FLOATS:
+            value.type = VALUE_FLOAT;
+            value.data.float_val = ((const float*)list->raw)[index];
+            return value;
+        default:
+            return list->items[index];
+    }
+}
+
+// Função para iniciar um iterador sobre o intervalo [start, end)
+void iterator_range(Iterator* it, long long start, long long end) {
+    it->kind = ITER_RANGE;
+    it->current = start;
+    it->end = end;
+    it->list = NULL;
+    it->allocator = NULL;
+    it->failed = 0;
+}
+
+// Função para iniciar um iterador sobre uma lista
+void iterator_list(Iterator* it, Allocator* allocator, List* list) {
+    it->kind = ITER_LIST;
+    it->current = 0;
+    it->end = list->count;
+    it->list = list;
+    it->allocator = allocator;
+    it->failed = 0;
+    list_retain(list);
+}
+
+// Função para obter o próximo elemento
+int iterator_next(Iterator* it, Value* element) {
+    if (it->current >= it->end) {
+        return 0;
+    }
+    if (it->kind == ITER_RANGE) {
+        element->type = VALUE_INTEGER;
+        element->data.int_val = (int)it->current++;
+        return 1;
+    }
+    if (!copy_value(it->allocator, list_get(it->list, (int)it->current++), element)) {
+        it->failed = 1;
+        return 0;
+    }
+    return 1;
+}
+
+// Função para liberar o iterador
+void iterator_close(Iterator* it) {
+    if (it->kind == ITER_LIST) {
+        list_release(it->allocator, it->list);
+        it->list = NULL;
+    }
+}
@@ -8,8 +8,9 @@
 #include "lexer.h"
 
 // Função para inicializar o lexer
-void lexer_init(Lexer* lexer, const char* source) {
+void lexer_init(Lexer* lexer, const char* source, Allocator* allocator) {
     lexer->source = source;
+    lexer->allocator = allocator;
     lexer->current_pos = 0;
     lexer->line = 1;
     lexer->column = 1;
@@ -40,25 +41,25 @@ static int is_at_end(Lexer* lexer) {
 }
 
 // Função auxiliar para criar um token
-Token make_token(TokenType type, const char* start, int length, int line, int column) {
+Token make_token(Allocator* allocator, TokenType type, const char* start, int length, int line, int column) {
     Token token;
     token.type = type;
-    token.lexeme = (char*)malloc(length + 1);
-    if (token.lexeme == NULL) {
-        fprintf(stderr, "Erro: Falha na alocação de memória para lexeme.\n");
-        exit(1);
-    }
-    strncpy(token.lexeme, start, length);
-    token.lexeme[length] = '\0';
+    token.lexeme = mem_strndup(allocator, MEM_LEXER, start, length);
     token.line = line;
     token.column = column;
+    if (token.lexeme == NULL) {
+        // Sem memória: devolve um token de erro para o parser reportar
+        token.type = TOKEN_ERROR;
+        token.lexeme = (char*)"Falha na alocação de memória para lexeme.";
+        return token;
+    }
     return token;
 }
 
 // Função auxiliar para criar um token de erro
 static Token error_token(const char* message, int line, int column) {
     Token token;
-    token.type = TOKEN_EOF; // Usar EOF para indicar erro, ou criar um TOKEN_ERROR
+    token.type = TOKEN_ERROR;
     token.lexeme = (char*)message; // Não alocar, é uma string literal
     token.line = line;
     token.column = column;
@@ -66,9 +67,10 @@ static Token error_token(const char* message, int line, int column) {
 }
 
 // Função para liberar a memória de um token
-void token_free(Token* token) {
-    if (token->lexeme != NULL && token->type != TOKEN_EOF) {
-        free(token->lexeme);
+void token_free(Allocator* allocator, Token* token) {
+    // Tokens de erro apontam para strings literais e não são liberados
+    if (token->lexeme != NULL && token->type != TOKEN_ERROR) {
+        mem_free(allocator, token->lexeme);
         token->lexeme = NULL;
     }
 }
@@ -126,33 +128,35 @@ static Token identifier(Lexer* lexer) {
     const char* text = lexer->source + start_pos;
 
     // Verificar palavras-chave
-    if (length == 3 && strncmp(text, "get", 3) == 0) return make_token(TOKEN_GET, text, length, lexer->line, lexer->column - length);
-    if (length == 5 && strncmp(text, "print", 5) == 0) return make_token(TOKEN_PRINT, text, length, lexer->line, lexer->column - length);
-    if (length == 2 && strncmp(text, "if", 2) == 0) return make_token(TOKEN_IF, text, length, lexer->line, lexer->column - length);
-    if (length == 4 && strncmp(text, "else", 4) == 0) return make_token(TOKEN_ELSE, text, length, lexer->line, lexer->column - length);
-    if (length == 7 && strncmp(text, "else if", 7) == 0) return make_token(TOKEN_ELSE_IF, text, length, lexer->line, lexer->column - length);
-    if (length == 5 && strncmp(text, "while", 5) == 0) return make_token(TOKEN_WHILE, text, length, lexer->line, lexer->column - length);
-    if (length == 3 && strncmp(text, "for", 3) == 0) return make_token(TOKEN_FOR, text, length, lexer->line, lexer->column - length);
-    if (length == 4 && strncmp(text, "loop", 4) == 0) return make_token(TOKEN_LOOP, text, length, lexer->line, lexer->column - length);
-    if (length == 4 && strncmp(text, "wait", 4) == 0) return make_token(TOKEN_WAIT, text, length, lexer->line, lexer->column - length);
-    if (length == 3 && strncmp(text, "fun", 3) == 0) return make_token(TOKEN_FUN, text, length, lexer->line, lexer->column - length);
-    if (length == 6 && strncmp(text, "return", 6) == 0) return make_token(TOKEN_RETURN, text, length, lexer->line, lexer->column - length);
-    if (length == 6 && strncmp(text, "system", 6) == 0) return make_token(TOKEN_SYSTEM, text, length, lexer->line, lexer->column - length);
-    if (length == 6 && strncmp(text, "import", 6) == 0) return make_token(TOKEN_IMPORT, text, length, lexer->line, lexer->column - length);
+    if (length == 3 && strncmp(text, "get", 3) == 0) return make_token(lexer->allocator, TOKEN_GET, text, length, lexer->line, lexer->column - length);
+    if (length == 5 && strncmp(text, "print", 5) == 0) return make_token(lexer->allocator, TOKEN_PRINT, text, length, lexer->line, lexer->column - length);
+    if (length == 2 && strncmp(text, "if", 2) == 0) return make_token(lexer->allocator, TOKEN_IF, text, length, lexer->line, lexer->column - length);
+    if (length == 4 && strncmp(text, "else", 4) == 0) return make_token(lexer->allocator, TOKEN_ELSE, text, length, lexer->line, lexer->column - length);
+    if (length == 7 && strncmp(text, "else if", 7) == 0) return make_token(lexer->allocator, TOKEN_ELSE_IF, text, length, lexer->line, lexer->column - length);
+    if (length == 5 && strncmp(text, "while", 5) == 0) return make_token(lexer->allocator, TOKEN_WHILE, text, length, lexer->line, lexer->column - length);
+    if (length == 3 && strncmp(text, "for", 3) == 0) return make_token(lexer->allocator, TOKEN_FOR, text, length, lexer->line, lexer->column - length);
+    if (length == 4 && strncmp(text, "loop", 4) == 0) return make_token(lexer->allocator, TOKEN_LOOP, text, length, lexer->line, lexer->column - length);
+    if (length == 4 && strncmp(text, "wait", 4) == 0) return make_token(lexer->allocator, TOKEN_WAIT, text, length, lexer->line, lexer->column - length);
+    if (length == 3 && strncmp(text, "fun", 3) == 0) return make_token(lexer->allocator, TOKEN_FUN, text, length, lexer->line, lexer->column - length);
+    if (length == 6 && strncmp(text, "return", 6) == 0) return make_token(lexer->allocator, TOKEN_RETURN, text, length, lexer->line, lexer->column - length);
+    if (length == 6 && strncmp(text, "system", 6) == 0) return make_token(lexer->allocator, TOKEN_SYSTEM, text, length, lexer->line, lexer->column - length);
+    if (length == 6 && strncmp(text, "import", 6) == 0) return make_token(lexer->allocator, TOKEN_IMPORT, text, length, lexer->line, lexer->column - length);
+    if (length == 4 && strncmp(text, "save", 4) == 0) return make_token(lexer->allocator, TOKEN_SAVE, text, length, lexer->line, lexer->column - length);
+    if (length == 4 && strncmp(text, "load", 4) == 0) return make_token(lexer->allocator, TOKEN_LOAD, text, length, lexer->line, lexer->column - length);
 
     // Tipos de variáveis
-    if (length == 3 && strncmp(text, "int", 3) == 0) return make_token(TOKEN_TYPE_INT, text, length, lexer->line, lexer->column - length);
-    if (length == 5 && strncmp(text, "float", 5) == 0) return make_token(TOKEN_TYPE_FLOAT, text, length, lexer->line, lexer->column - length);
-    if (length == 6 && strncmp(text, "string", 6) == 0) return make_token(TOKEN_TYPE_STRING, text, length, lexer->line, lexer->column - length);
-    if (length == 4 && strncmp(text, "dict", 4) == 0) return make_token(TOKEN_TYPE_DICT, text, length, lexer->line, lexer->column - length);
-    if (length == 6 && strncmp(text, "vector", 6) == 0) return make_token(TOKEN_TYPE_VECTOR, text, length, lexer->line, lexer->column - length);
+    if (length == 3 && strncmp(text, "int", 3) == 0) return make_token(lexer->allocator, TOKEN_TYPE_INT, text, length, lexer->line, lexer->column - length);
+    if (length == 5 && strncmp(text, "float", 5) == 0) return make_token(lexer->allocator, TOKEN_TYPE_FLOAT, text, length, lexer->line, lexer->column - length);
+    if (length == 6 && strncmp(text, "string", 6) == 0) return make_token(lexer->allocator, TOKEN_TYPE_STRING, text, length, lexer->line, lexer->column - length);
+    if (length == 4 && strncmp(text, "dict", 4) == 0) return make_token(lexer->allocator, TOKEN_TYPE_DICT, text, length, lexer->line, lexer->column - length);
+    if (length == 6 && strncmp(text, "vector", 6) == 0) return make_token(lexer->allocator, TOKEN_TYPE_VECTOR, text, length, lexer->line, lexer->column - length);
 
     // Palavras-chave de formatação de print
-    if (length == 2 && strncmp(text, "br", 2) == 0) return make_token(TOKEN_BR, text, length, lexer->line, lexer->column - length);
-    if (length == 3 && strncmp(text, "tab", 3) == 0) return make_token(TOKEN_TAB, text, length, lexer->line, lexer->column - length);
-    if (length == 5 && strncmp(text, "color", 5) == 0) return make_token(TOKEN_COLOR, text, length, lexer->line, lexer->column - length);
+    if (length == 2 && strncmp(text, "br", 2) == 0) return make_token(lexer->allocator, TOKEN_BR, text, length, lexer->line, lexer->column - length);
+    if (length == 3 && strncmp(text, "tab", 3) == 0) return make_token(lexer->allocator, TOKEN_TAB, text, length, lexer->line, lexer->column - length);
+    if (length == 5 && strncmp(text, "color", 5) == 0) return make_token(lexer->allocator, TOKEN_COLOR, text, length, lexer->line, lexer->column - length);
 
-    return make_token(TOKEN_IDENTIFIER, text, length, lexer->line, lexer->column - length);
+    return make_token(lexer->allocator, TOKEN_IDENTIFIER, text, length, lexer->line, lexer->column - length);
 }
 
 // Função para identificar números (inteiros e floats)
@@ -166,9 +170,9 @@ static Token number(Lexer* lexer) {
         while (isdigit(peek(lexer))) {
             advance(lexer);
         }
-        return make_token(TOKEN_FLOAT, lexer->source + start_pos, lexer->current_pos - start_pos, lexer->line, lexer->column - (lexer->current_pos - start_pos));
+        return make_token(lexer->allocator, TOKEN_FLOAT, lexer->source + start_pos, lexer->current_pos - start_pos, lexer->line, lexer->column - (lexer->current_pos - start_pos));
     }
-    return make_token(TOKEN_INTEGER, lexer->source + start_pos, lexer->current_pos - start_pos, lexer->line, lexer->column - (lexer->current_pos - start_pos));
+    return make_token(lexer->allocator, TOKEN_INTEGER, lexer->source + start_pos, lexer->current_pos - start_pos, lexer->line, lexer->column - (lexer->current_pos - start_pos));
 }
 
 // Função para identificar strings
@@ -185,7 +189,7 @@ static Token string(Lexer* lexer) {
         return error_token("String não terminada.", lexer->line, lexer->column);
     }
     advance(lexer); // Consome a aspa final
-    return make_token(TOKEN_STRING, lexer->source + start_pos, lexer->current_pos - start_pos - 1, lexer->line, lexer->column - (lexer->current_pos - start_pos));
+    return make_token(lexer->allocator, TOKEN_STRING, lexer->source + start_pos, lexer->current_pos - start_pos - 1, lexer->line, lexer->column - (lexer->current_pos - start_pos));
 }
 
 // Função principal para obter o próximo token
@@ -193,7 +197,7 @@ Token lexer_next_token(Lexer* lexer) {
     skip_whitespace_and_comments(lexer);
 
     if (is_at_end(lexer)) {
-        return make_token(TOKEN_EOF, "", 0, lexer->line, lexer->column);
+        return make_token(lexer->allocator, TOKEN_EOF, "", 0, lexer->line, lexer->column);
     }
 
     char c = advance(lexer);
@@ -205,63 +209,71 @@ Token lexer_next_token(Lexer* lexer) {
 
     switch (c) {
         case '(':
-            return make_token(TOKEN_LPAREN, "(", 1, current_line, current_column);
+            return make_token(lexer->allocator, TOKEN_LPAREN, "(", 1, current_line, current_column);
         case ')':
-            return make_token(TOKEN_RPAREN, ")", 1, current_line, current_column);
+            return make_token(lexer->allocator, TOKEN_RPAREN, ")", 1, current_line, current_column);
         case '{':
-            return make_token(TOKEN_LBRACE, "{", 1, current_line, current_column);
+            return make_token(lexer->allocator, TOKEN_LBRACE, "{", 1, current_line, current_column);
         case '}':
-            return make_token(TOKEN_RBRACE, "}", 1, current_line, current_column);
+            return make_token(lexer->allocator, TOKEN_RBRACE, "}", 1, current_line, current_column);
         case '[':
-            return make_token(TOKEN_LBRACKET, "[", 1, current_line, current_column);
+            return make_token(lexer->allocator, TOKEN_LBRACKET, "[", 1, current_line, current_column);
         case ']':
-            return make_token(TOKEN_RBRACKET, "]", 1, current_line, current_column);
+            return make_token(lexer->allocator, TOKEN_RBRACKET, "]", 1, current_line, current_column);
         case ';':
-            return make_token(TOKEN_SEMICOLON, ";", 1, current_line, current_column);
+            return make_token(lexer->allocator, TOKEN_SEMICOLON, ";", 1, current_line, current_column);
         case ',':
-            return make_token(TOKEN_COMMA, ",", 1, current_line, current_column);
+            return make_token(lexer->allocator, TOKEN_COMMA, ",", 1, current_line, current_column);
         case ':':
-            return make_token(TOKEN_COLON, ":", 1, current_line, current_column);
+            return make_token(lexer->allocator, TOKEN_COLON, ":", 1, current_line, current_column);
         case '.':
-            return make_token(TOKEN_DOT, ".", 1, current_line, current_column);
+            if (peek(lexer) == '.') {
+                advance(lexer);
+                return make_token(lexer->allocator, TOKEN_RANGE, "..", 2, current_line, current_column);
+            }
+            return make_token(lexer->allocator, TOKEN_DOT, ".", 1, current_line, current_column);
         case '+':
-            return make_token(TOKEN_PLUS, "+", 1, current_line, current_column);
+            return make_token(lexer->allocator, TOKEN_PLUS, "+", 1, current_line, current_column);
         case '-':
             if (peek(lexer) == '>') {
                 advance(lexer);
                 if (peek(lexer) == '+') {
                     advance(lexer);
-                    return make_token(TOKEN_ARROW_RIGHT_APPEND, "->+", 3, current_line, current_column);
+                    return make_token(lexer->allocator, TOKEN_ARROW_RIGHT_APPEND, "->+", 3, current_line, current_column);
                 }
-                return make_token(TOKEN_ARROW_RIGHT, "->", 2, current_line, current_column);
+                return make_token(lexer->allocator, TOKEN_ARROW_RIGHT, "->", 2, current_line, current_column);
             }
-            return make_token(TOKEN_MINUS, "-", 1, current_line, current_column);
+            return make_token(lexer->allocator, TOKEN_MINUS, "-", 1, current_line, current_column);
         case '*':
-            return make_token(TOKEN_MULTIPLY, "*", 1, current_line, current_column);
+            return make_token(lexer->allocator, TOKEN_MULTIPLY, "*", 1, current_line, current_column);
         case '/':
-            return make_token(TOKEN_DIVIDE, "/", 1, current_line, current_column);
+            return make_token(lexer->allocator, TOKEN_DIVIDE, "/", 1, current_line, current_column);
         case '=':
-            return make_token(TOKEN_ASSIGN, "=", 1, current_line, current_column);
+            if (peek(lexer) == '=') {
+                advance(lexer);
+                return make_token(lexer->allocator, TOKEN_EQ, "==", 2, current_line, current_column);
+            }
+            return make_token(lexer->allocator, TOKEN_ASSIGN, "=", 1, current_line, current_column);
         case '<':
             if (peek(lexer) == '-') {
                 advance(lexer);
-                return make_token(TOKEN_ARROW_LEFT, "<-", 2, current_line, current_column);
+                return make_token(lexer->allocator, TOKEN_ARROW_LEFT, "<-", 2, current_line, current_column);
             }
             if (peek(lexer) == '=') {
                 advance(lexer);
-                return make_token(TOKEN_LE, "<=", 2, current_line, current_column);
+                return make_token(lexer->allocator, TOKEN_LE, "<=", 2, current_line, current_column);
             }
-            return make_token(TOKEN_LT, "<", 1, current_line, current_column);
+            return make_token(lexer->allocator, TOKEN_LT, "<", 1, current_line, current_column);
         case '>':
             if (peek(lexer) == '=') {
                 advance(lexer);
-                return make_token(TOKEN_GE, ">=", 2, current_line, current_column);
+                return make_token(lexer->allocator, TOKEN_GE, ">=", 2, current_line, current_column);
             }
-            return make_token(TOKEN_GT, ">", 1, current_line, current_column);
+            return make_token(lexer->allocator, TOKEN_GT, ">", 1, current_line, current_column);
         case '!':
             if (peek(lexer) == '=') {
                 advance(lexer);
-                return make_token(TOKEN_NEQ, "!=", 2, current_line, current_column);
+                return make_token(lexer->allocator, TOKEN_NEQ, "!=", 2, current_line, current_column);
             }
             break; // Erro se for apenas '!'
         case '"':
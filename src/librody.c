@@ -0,0 +1,212 @@
+
+/* librody.c */
+
+#include <stdlib.h>
+#include "librody.h"
+#include "lexer.h"
+#include "parser.h"
+
+// Estado completo de uma instância do interpretador
+struct RodyVM {
+    Allocator allocator;
+    Interpreter interpreter;
+    RodyError error; // Último erro reportado por rody_vm_eval
+    ModuleTable modules; // Módulos importados, analisados em paralelo
+    Tracer* tracer; // NULL quando o registro de eventos está desligado
+    ASTNode** programs; // Programas que declararam ou redefiniram funções (vivem até rody_vm_free)
+    int num_programs;
+    int program_capacity;
+};
+
+// Função para criar uma nova instância
+RodyVM* rody_vm_new(void) {
+    return rody_vm_new_with_backend(ALLOC_SYSTEM);
+}
+
+// Função para criar uma instância com um backend de alocação específico
+RodyVM* rody_vm_new_with_backend(AllocatorBackend backend) {
+    RodyVM* vm = (RodyVM*)malloc(sizeof(RodyVM));
+    if (vm == NULL) {
+        return NULL;
+    }
+    allocator_init(&vm->allocator, backend);
+    interpreter_init(&vm->interpreter, &vm->allocator);
+    modules_init(&vm->modules, backend);
+    vm->interpreter.modules = &vm->modules;
+    error_init(&vm->error);
+    vm->tracer = NULL;
+    vm->programs = NULL;
+    vm->num_programs = 0;
+    vm->program_capacity = 0;
+    return vm;
+}
+
+// Função para liberar uma instância e todo o seu estado
+void rody_vm_free(RodyVM* vm) {
+    if (vm == NULL) {
+        return;
+    }
+    interpreter_free(&vm->interpreter);
+    for (int i = 0; i < vm->num_programs; i++) {
+        free_ast(&vm->allocator, vm->programs[i]);
+    }
+    mem_free(&vm->allocator, vm->programs);
+    modules_free(&vm->modules);
+    allocator_free(&vm->allocator);
+    free(vm);
+}
+
+// Função para avaliar um código fonte na instância
+RodyStatus rody_vm_eval(RodyVM* vm, const char* source, Value* result) {
+    if (result != NULL) {
+        result->type = VALUE_NULL;
+    }
+    error_init(&vm->error);
+
+    TraceRing* trace = vm->tracer != NULL ? tracer_thread_ring(vm->tracer) : NULL;
+    long long start_ns = trace != NULL ? trace_now() : 0;
+
+    // Os módulos importados são analisados por outras threads enquanto esta
+    // analisa o fonte principal
+    vm->modules.tracer = vm->tracer;
+    modules_begin(&vm->modules, source);
+
+    Lexer lexer;
+    lexer_init(&lexer, source, &vm->allocator);
+
+    Parser parser;
+    parser_init(&parser, &lexer);
+
+    // O lexer é consumido sob demanda pelo parser, então o intervalo cobre os dois
+    ASTNode* program_ast = parse(&parser);
+    if (trace != NULL) {
+        trace_span(trace, "analise", "compilacao", start_ns, trace_now(), "lexer+parser");
+    }
+    modules_wait(&vm->modules);
+    if (trace != NULL) {
+        start_ns = trace_now();
+    }
+    if (program_ast == NULL) {
+        vm->error = parser.error;
+        return RODY_ERROR_SYNTAX;
+    }
+    if (!modules_link(&vm->modules, &vm->error)) {
+        free_ast(&vm->allocator, program_ast);
+        return RODY_ERROR_IMPORT;
+    }
+
+    // As funções declaradas apontam para a AST, que então precisa sobreviver à
+    // execução; a vaga é reservada antes para não haver falha depois
+    if (vm->num_programs == vm->program_capacity) {
+        int capacity = vm->program_capacity == 0 ? 4 : vm->program_capacity * 2;
+        ASTNode** programs = (ASTNode**)mem_realloc(&vm->allocator, MEM_PARSER, vm->programs, capacity * sizeof(ASTNode*));
+        if (programs == NULL) {
+            free_ast(&vm->allocator, program_ast);
+            error_set(&vm->error, 0, 0, "Erro: Falha na alocação de memória para o programa.");
+            return RODY_ERROR_RUNTIME;
+        }
+        vm->programs = programs;
+        vm->program_capacity = capacity;
+    }
+
+    error_init(&vm->interpreter.error);
+    vm->interpreter.import_failed = 0;
+    vm->interpreter.trace = trace;
+    int declarations = vm->interpreter.declarations;
+    Value value = interpret(&vm->interpreter, program_ast);
+    if (vm->interpreter.declarations > declarations) {
+        vm->programs[vm->num_programs++] = program_ast;
+    } else {
+        free_ast(&vm->allocator, program_ast);
+    }
+    output_flush(&vm->interpreter.output);
+    if (trace != NULL) {
+        trace_span(trace, "execucao", "execucao", start_ns, trace_now(), NULL);
+    }
+
+    if (vm->interpreter.error.has_error) {
+        free_value(&vm->allocator, value);
+        vm->error = vm->interpreter.error;
+        return vm->interpreter.import_failed ? RODY_ERROR_IMPORT : RODY_ERROR_RUNTIME;
+    }
+
+    if (result != NULL) {
+        *result = value;
+    } else {
+        free_value(&vm->allocator, value);
+    }
+    return RODY_OK;
+}
+
+// Função para redirecionar a saída do print (descarrega a saída pendente)
+void rody_vm_set_output(RodyVM* vm, int fd, int line_buffered) {
+    output_set_fd(&vm->interpreter.output, fd, line_buffered);
+}
+
+// Função para trocar o descritor lido pelo get
+void rody_vm_set_input(RodyVM* vm, int fd) {
+    input_set_fd(&vm->interpreter.input, fd);
+}
+
+// Função para definir o diretório onde os imports são procurados
+void rody_vm_set_import_path(RodyVM* vm, const char* dir) {
+    modules_set_search_dir(&vm->modules, dir);
+}
+
+// Função para definir quantas threads analisam os imports
+void rody_vm_set_import_threads(RodyVM* vm, int threads) {
+    vm->modules.threads = threads;
+}
+
+// Função para definir o limite do cache de cada função pura (0 desliga)
+void rody_vm_set_memo_size(RodyVM* vm, int entries) {
+    vm->interpreter.memo_size = entries;
+}
+
+// Função para obter o número de módulos carregados pela instância
+int rody_vm_module_count(const RodyVM* vm) {
+    return vm->modules.count;
+}
+
+// Função para obter o erro de um módulo (NULL se ele foi carregado sem erro)
+const char* rody_vm_module_error(const RodyVM* vm, int index) {
+    if (index < 0 || index >= vm->modules.count || !vm->modules.modules[index]->error.has_error) {
+        return NULL;
+    }
+    return vm->modules.modules[index]->error.message;
+}
+
+// Função para liberar um valor devolvido por rody_vm_eval
+void rody_value_free(RodyVM* vm, Value value) {
+    free_value(&vm->allocator, value);
+}
+
+// Função para obter o alocador da instância
+const Allocator* rody_vm_allocator(const RodyVM* vm) {
+    return &vm->allocator;
+}
+
+// Função para obter a soma dos contadores dos alocadores dos módulos
+const Allocator* rody_vm_modules_allocator(const RodyVM* vm) {
+    return &vm->modules.stats;
+}
+
+// Função para ligar (ou desligar, com NULL) o profiler por instrumentação
+void rody_vm_set_profiler(RodyVM* vm, Profiler* profiler) {
+    vm->interpreter.profiler = profiler;
+}
+
+// Função para ligar (ou desligar, com NULL) a pilha-sombra lida pelo sampler
+void rody_vm_set_sampler(RodyVM* vm, Sampler* sampler) {
+    vm->interpreter.shadow = sampler != NULL ? &sampler->shadow : NULL;
+}
+
+// Função para ligar (ou desligar, com NULL) o registro de eventos
+void rody_vm_set_tracer(RodyVM* vm, Tracer* tracer) {
+    vm->tracer = tracer;
+}
+
+// Função para obter a mensagem do último erro da instância
+const char* rody_vm_error(const RodyVM* vm) {
+    return vm->error.message;
+}
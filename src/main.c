@@ -1,20 +1,123 @@
+
 /* main.c */
 
 #include <stdio.h>
 #include <stdlib.h>
-#include "lexer.h"
-#include "parser.h"
-#include "interpreter.h"
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include "librody.h"
+
+// Alocadores lidos pelo tratador de SIGUSR1 (estado global só do CLI): o da
+// instância e a soma dos módulos importados
+static const Allocator* volatile stats_allocator = NULL;
+static const Allocator* volatile stats_modules = NULL;
+
+// Tratador de SIGUSR1: imprime as estatísticas de memória sem interromper o script
+static void sigusr1_handler(int signo) {
+    (void)signo;
+    if (stats_allocator != NULL) {
+        mem_stats_write_merged(stats_allocator, stats_modules, STDERR_FILENO);
+    }
+}
+
+// Função para imprimir as opções de linha de comando
+static void usage(const char* program) {
+    fprintf(stderr, "Uso: %s [opções] <arquivo_rody>\n", program);
+    fprintf(stderr, "Opções:\n");
+    fprintf(stderr, "  --profile              imprime o perfil por tipo de nó e por linha ao final\n");
+    fprintf(stderr, "  --profile-out=ARQUIVO  grava também as pilhas no formato folded (flamegraph)\n");
+    fprintf(stderr, "  --sample-profile=HZ    amostra a pilha do script HZ vezes por segundo (SIGPROF)\n");
+    fprintf(stderr, "  --sample-out=ARQUIVO   arquivo folded das amostras (padrão: rody-samples.folded)\n");
+    fprintf(stderr, "  --trace=ARQUIVO        grava a linha do tempo da execução (Chrome Trace Event, JSON)\n");
+    fprintf(stderr, "  --line-buffered        descarrega a saída do print a cada quebra de linha\n");
+    fprintf(stderr, "  --mem-stats            imprime as estatísticas de memória ao final e em SIGUSR1\n");
+    fprintf(stderr, "  --allocator=NOME       backend de alocação: system (padrão), arena ou debug\n");
+    fprintf(stderr, "  --import-threads=N     threads que analisam os imports (padrão: número de núcleos)\n");
+    fprintf(stderr, "  --memo-size=N          resultados guardados por função pura (padrão: 4096; 0 desliga)\n");
+}
 
 int main(int argc, char* argv[]) {
-    if (argc < 2) {
-        fprintf(stderr, "Uso: %s <arquivo_rody>\n", argv[0]);
+    const char* path = NULL;
+    int profile = 0;
+    const char* profile_out = NULL;
+    int sample_hz = 0;
+    const char* sample_out = "rody-samples.folded";
+    int mem_stats = 0;
+    const char* trace_out = NULL;
+    int line_buffered = 0;
+    int import_threads = 0;
+    int memo_size = -1;
+    AllocatorBackend backend = ALLOC_SYSTEM;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--profile") == 0) {
+            profile = 1;
+        } else if (strncmp(argv[i], "--profile-out=", 14) == 0) {
+            profile = 1;
+            profile_out = argv[i] + 14;
+        } else if (strncmp(argv[i], "--sample-profile=", 17) == 0) {
+            sample_hz = atoi(argv[i] + 17);
+            if (sample_hz <= 0) {
+                fprintf(stderr, "Erro: Frequência de amostragem inválida: %s\n", argv[i] + 17);
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--sample-out=", 13) == 0) {
+            sample_out = argv[i] + 13;
+        } else if (strncmp(argv[i], "--trace=", 8) == 0) {
+            trace_out = argv[i] + 8;
+        } else if (strcmp(argv[i], "--line-buffered") == 0) {
+            line_buffered = 1;
+        } else if (strcmp(argv[i], "--mem-stats") == 0) {
+            mem_stats = 1;
+        } else if (strncmp(argv[i], "--allocator=", 12) == 0) {
+            if (!allocator_backend_from_name(argv[i] + 12, &backend)) {
+                fprintf(stderr, "Erro: Backend de alocação desconhecido: %s\n", argv[i] + 12);
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--import-threads=", 17) == 0) {
+            import_threads = atoi(argv[i] + 17);
+            if (import_threads <= 0) {
+                fprintf(stderr, "Erro: Número de threads inválido: %s\n", argv[i] + 17);
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--memo-size=", 12) == 0) {
+            char* end;
+            memo_size = (int)strtol(argv[i] + 12, &end, 10);
+            if (end == argv[i] + 12 || *end != '\0' || memo_size < 0) {
+                fprintf(stderr, "Erro: Tamanho de cache inválido: %s\n", argv[i] + 12);
+                return 1;
+            }
+        } else if (argv[i][0] == '-' && argv[i][1] == '-') {
+            fprintf(stderr, "Erro: Opção desconhecida %s\n", argv[i]);
+            usage(argv[0]);
+            return 1;
+        } else if (path == NULL) {
+            path = argv[i];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (path == NULL) {
+        usage(argv[0]);
         return 1;
     }
 
-    FILE* file = fopen(argv[1], "r");
+    Tracer tracer;
+    TraceRing* trace = NULL;
+    if (trace_out != NULL) {
+        tracer_init(&tracer, 0);
+        trace = tracer_thread_ring(&tracer);
+    }
+    long long read_start_ns = trace != NULL ? trace_now() : 0;
+
+    FILE* file = fopen(path, "r");
     if (file == NULL) {
-        fprintf(stderr, "Erro: Não foi possível abrir o arquivo %s\n", argv[1]);
+        fprintf(stderr, "Erro: Não foi possível abrir o arquivo %s\n", path);
+        if (trace_out != NULL) {
+            tracer_free(&tracer);
+        }
         return 1;
     }
 
@@ -26,30 +129,120 @@ int main(int argc, char* argv[]) {
     if (source == NULL) {
         fprintf(stderr, "Erro: Falha na alocação de memória para o código fonte.\n");
         fclose(file);
+        if (trace_out != NULL) {
+            tracer_free(&tracer);
+        }
         return 1;
     }
-    fread(source, 1, length, file);
+    length = (long)fread(source, 1, length, file);
     source[length] = '\0';
     fclose(file);
+    trace_span(trace, "leitura_arquivo", "io", read_start_ns, trace_now(), path);
+
+    RodyVM* vm = rody_vm_new_with_backend(backend);
+    if (vm == NULL) {
+        fprintf(stderr, "Erro: Falha na alocação de memória para o interpretador.\n");
+        free(source);
+        if (trace_out != NULL) {
+            tracer_free(&tracer);
+        }
+        return 1;
+    }
+
+    if (mem_stats) {
+        stats_modules = rody_vm_modules_allocator(vm);
+        stats_allocator = rody_vm_allocator(vm);
+        struct sigaction action;
+        memset(&action, 0, sizeof(action));
+        action.sa_handler = sigusr1_handler;
+        action.sa_flags = SA_RESTART;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGUSR1, &action, NULL);
+    }
+
+    if (trace_out != NULL) {
+        rody_vm_set_tracer(vm, &tracer);
+    }
 
-    Lexer lexer;
-    lexer_init(&lexer, source);
+    // Os imports são procurados no diretório do script
+    const char* slash = strrchr(path, '/');
+    if (slash != NULL) {
+        char dir[1024];
+        snprintf(dir, sizeof(dir), "%.*s", (int)(slash - path), path);
+        rody_vm_set_import_path(vm, slash == path ? "/" : dir);
+    }
+    rody_vm_set_import_threads(vm, import_threads);
+    if (memo_size >= 0) {
+        rody_vm_set_memo_size(vm, memo_size);
+    }
+    if (line_buffered) {
+        rody_vm_set_output(vm, STDOUT_FILENO, 1);
+    }
 
-    Parser parser;
-    parser_init(&parser, &lexer);
+    Profiler profiler;
+    if (profile) {
+        profiler_init(&profiler);
+        rody_vm_set_profiler(vm, &profiler);
+    }
 
-    ASTNode* program_ast = parse(&parser);
+    Sampler sampler;
+    if (sample_hz > 0) {
+        if (!sampler_init(&sampler, sample_hz)) {
+            fprintf(stderr, "Erro: Falha na alocação de memória para o sampler.\n");
+            sample_hz = 0;
+        } else if (!sampler_start(&sampler)) {
+            fprintf(stderr, "Erro: Não foi possível iniciar a amostragem.\n");
+            sampler_free(&sampler);
+            sample_hz = 0;
+        } else {
+            rody_vm_set_sampler(vm, &sampler);
+        }
+    }
 
-    SymbolTable global_table;
-    init_symbol_table(&global_table);
+    RodyStatus status = rody_vm_eval(vm, source, NULL);
+    if (status != RODY_OK) {
+        fprintf(stderr, "%s\n", rody_vm_error(vm));
+    }
 
-    interpret(program_ast, &global_table);
+    if (sample_hz > 0) {
+        sampler_stop(&sampler);
+        rody_vm_set_sampler(vm, NULL);
+        sampler_report(&sampler, stderr);
+        if (!sampler_write_folded(&sampler, sample_out)) {
+            fprintf(stderr, "Erro: Não foi possível gravar as amostras em %s\n", sample_out);
+        }
+        sampler_free(&sampler);
+    }
+
+    if (profile) {
+        profiler_report(&profiler, stderr);
+        if (profile_out != NULL && !profiler_write_folded(&profiler, profile_out)) {
+            fprintf(stderr, "Erro: Não foi possível gravar o perfil em %s\n", profile_out);
+        }
+        profiler_free(&profiler);
+    }
+
+    if (mem_stats) {
+        signal(SIGUSR1, SIG_DFL);
+        stats_allocator = NULL;
+        mem_stats_write_merged(rody_vm_allocator(vm), rody_vm_modules_allocator(vm), STDERR_FILENO);
+    }
+
+    if (trace_out != NULL) {
+        if (!tracer_write(&tracer, trace_out)) {
+            fprintf(stderr, "Erro: Não foi possível gravar o trace em %s\n", trace_out);
+        }
+        tracer_free(&tracer);
+    }
 
     // Libera a memória
-    free_ast(program_ast);
-    free_symbol_table(&global_table);
+    rody_vm_free(vm);
     free(source);
 
+    if (status != RODY_OK) {
+        return 1;
+    }
+
     printf("Interpretação concluída com sucesso.\n");
 
     return 0;
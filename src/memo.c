@@ -0,0 +1,220 @@
+
+/* memo.c */
+
+#include <string.h>
+#include "memo.h"
+
+// Função para inicializar um cache vazio
+void memo_init(MemoCache* cache, Allocator* allocator, int capacity, int num_args) {
+    memset(cache, 0, sizeof(MemoCache));
+    cache->allocator = allocator;
+    cache->capacity = num_args <= RODY_MAX_PARAMS ? capacity : 0;
+    cache->num_args = num_args;
+    cache->head = -1;
+    cache->tail = -1;
+}
+
+// Função para liberar o cache e os valores guardados
+void memo_free(MemoCache* cache) {
+    for (int i = 0; i < cache->count; i++) {
+        MemoEntry* entry = &cache->entries[i];
+        for (int j = 0; j < cache->num_args; j++) {
+            free_value(cache->allocator, entry->args[j]);
+        }
+        free_value(cache->allocator, entry->result);
+    }
+    mem_free(cache->allocator, cache->entries);
+    mem_free(cache->allocator, cache->args);
+    mem_free(cache->allocator, cache->buckets);
+    cache->entries = NULL;
+    cache->args = NULL;
+    cache->buckets = NULL;
+    cache->count = 0;
+}
+
+// Função para esvaziar o cache
+void memo_clear(MemoCache* cache, int num_args) {
+    memo_free(cache);
+    cache->num_args = num_args;
+    cache->head = -1;
+    cache->tail = -1;
+}
+
+// Função para verificar se os argumentos podem ser chave
+int memo_can_key(const Value* args, int num_args) {
+    for (int i = 0; i < num_args; i++) {
+        if (args[i].type == VALUE_LIST || args[i].type == VALUE_DICT) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Função auxiliar para misturar bytes no hash (FNV-1a)
+static unsigned int mix(unsigned int hash, const void* data, size_t length) {
+    const unsigned char* p = (const unsigned char*)data;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= p[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Função para calcular o hash dos argumentos
+unsigned int memo_hash(const Value* args, int num_args) {
+    unsigned int hash = 2166136261u;
+    for (int i = 0; i < num_args; i++) {
+        unsigned char type = (unsigned char)args[i].type;
+        hash = mix(hash, &type, 1);
+        switch (args[i].type) {
+            case VALUE_INTEGER: hash = mix(hash, &args[i].data.int_val, sizeof(int)); break;
+            case VALUE_FLOAT: hash = mix(hash, &args[i].data.float_val, sizeof(float)); break;
+            case VALUE_STRING: hash = mix(hash, args[i].data.string_val, strlen(args[i].data.string_val)); break;
+            default: break;
+        }
+    }
+    return hash;
+}
+
+// Função auxiliar para comparar dois argumentos (floats bit a bit, como no hash)
+static int same_value(const Value* a, const Value* b) {
+    if (a->type != b->type) {
+        return 0;
+    }
+    switch (a->type) {
+        case VALUE_INTEGER: return a->data.int_val == b->data.int_val;
+        case VALUE_FLOAT: return memcmp(&a->data.float_val, &b->data.float_val, sizeof(float)) == 0;
+        case VALUE_STRING: return strcmp(a->data.string_val, b->data.string_val) == 0;
+        default: return 1;
+    }
+}
+
+// Função auxiliar para tirar uma entrada da lista LRU
+static void lru_unlink(MemoCache* cache, int index) {
+    MemoEntry* entry = &cache->entries[index];
+    if (entry->prev >= 0) {
+        cache->entries[entry->prev].next = entry->next;
+    } else {
+        cache->head = entry->next;
+    }
+    if (entry->next >= 0) {
+        cache->entries[entry->next].prev = entry->prev;
+    } else {
+        cache->tail = entry->prev;
+    }
+}
+
+// Função auxiliar para colocar uma entrada na frente da lista LRU
+static void lru_push_front(MemoCache* cache, int index) {
+    MemoEntry* entry = &cache->entries[index];
+    entry->prev = -1;
+    entry->next = cache->head;
+    if (cache->head >= 0) {
+        cache->entries[cache->head].prev = index;
+    } else {
+        cache->tail = index;
+    }
+    cache->head = index;
+}
+
+// Função para buscar um resultado
+const Value* memo_lookup(MemoCache* cache, const Value* args, unsigned int hash) {
+    if (cache->buckets != NULL) {
+        int index = cache->buckets[hash & (cache->num_buckets - 1)];
+        while (index >= 0) {
+            MemoEntry* entry = &cache->entries[index];
+            int match = entry->hash == hash;
+            for (int i = 0; i < cache->num_args && match; i++) {
+                match = same_value(&entry->args[i], &args[i]);
+            }
+            if (match) {
+                cache->stats.hits++;
+                if (cache->head != index) {
+                    lru_unlink(cache, index);
+                    lru_push_front(cache, index);
+                }
+                return &entry->result;
+            }
+            index = entry->chain;
+        }
+    }
+    cache->stats.misses++;
+    return NULL;
+}
+
+// Função auxiliar para reservar as entradas e a tabela na primeira inserção
+static int reserve(MemoCache* cache) {
+    int num_buckets = 1;
+    while (num_buckets < cache->capacity) {
+        num_buckets *= 2;
+    }
+    cache->entries = (MemoEntry*)mem_alloc(cache->allocator, MEM_INTERPRETER, cache->capacity * sizeof(MemoEntry));
+    cache->buckets = (int*)mem_alloc(cache->allocator, MEM_INTERPRETER, num_buckets * sizeof(int));
+    if (cache->num_args > 0) {
+        cache->args = (Value*)mem_alloc(cache->allocator, MEM_INTERPRETER,
+                                        (size_t)cache->capacity * cache->num_args * sizeof(Value));
+    }
+    if (cache->entries == NULL || cache->buckets == NULL || (cache->num_args > 0 && cache->args == NULL)) {
+        memo_free(cache);
+        return 0;
+    }
+    memset(cache->buckets, 0xff, num_buckets * sizeof(int)); // Todos -1
+    cache->num_buckets = num_buckets;
+    return 1;
+}
+
+// Função auxiliar para descartar a entrada usada há mais tempo; devolve a posição livre
+static int evict(MemoCache* cache) {
+    int index = cache->tail;
+    MemoEntry* entry = &cache->entries[index];
+    lru_unlink(cache, index);
+    int* link = &cache->buckets[entry->hash & (cache->num_buckets - 1)];
+    while (*link != index) {
+        link = &cache->entries[*link].chain;
+    }
+    *link = entry->chain;
+    for (int i = 0; i < cache->num_args; i++) {
+        free_value(cache->allocator, entry->args[i]);
+    }
+    free_value(cache->allocator, entry->result);
+    cache->stats.evictions++;
+    return index;
+}
+
+// Função para guardar uma cópia do resultado (e dos argumentos)
+int memo_store(MemoCache* cache, const Value* args, unsigned int hash, Value result) {
+    if (cache->capacity <= 0 || (cache->entries == NULL && !reserve(cache))) {
+        return 0;
+    }
+
+    // Copia tudo antes de mexer no cache: uma falta de memória não deixa entrada pela metade
+    Value copies[RODY_MAX_PARAMS];
+    Value result_copy;
+    if (!copy_value(cache->allocator, result, &result_copy)) {
+        return 0;
+    }
+    for (int i = 0; i < cache->num_args; i++) {
+        if (!copy_value(cache->allocator, args[i], &copies[i])) {
+            for (int j = 0; j < i; j++) {
+                free_value(cache->allocator, copies[j]);
+            }
+            free_value(cache->allocator, result_copy);
+            return 0;
+        }
+    }
+
+    int index = cache->count < cache->capacity ? cache->count++ : evict(cache);
+    MemoEntry* entry = &cache->entries[index];
+    entry->hash = hash;
+    entry->args = NULL;
+    if (cache->num_args > 0) {
+        entry->args = cache->args + (size_t)index * cache->num_args;
+        memcpy(entry->args, copies, cache->num_args * sizeof(Value));
+    }
+    entry->result = result_copy;
+    int* bucket = &cache->buckets[hash & (cache->num_buckets - 1)];
+    entry->chain = *bucket;
+    *bucket = index;
+    lru_push_front(cache, index);
+    return 1;
+}
@@ -0,0 +1,495 @@
+
+/* modules.c */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <signal.h>
+#include "modules.h"
+#include "lexer.h"
+#include "parser.h"
+
+// Função chamada pela pré-varredura para cada import encontrado
+typedef void (*ImportFound)(void* context, TokenType kind, const char* name);
+
+// Função para inicializar a tabela de módulos
+void modules_init(ModuleTable* table, AllocatorBackend backend) {
+    table->modules = NULL;
+    table->count = 0;
+    table->capacity = 0;
+    table->roots = NULL;
+    table->num_roots = 0;
+    strcpy(table->search_dir, ".");
+    table->backend = backend;
+    allocator_init(&table->stats, backend);
+    table->threads = 0;
+    table->tracer = NULL;
+    pthread_mutex_init(&table->lock, NULL);
+    pthread_cond_init(&table->changed, NULL);
+    table->next_job = 0;
+    table->active = 0;
+    table->num_workers = 0;
+    table->worker_limit = 0;
+}
+
+// Função para liberar todos os módulos
+void modules_free(ModuleTable* table) {
+    for (int i = 0; i < table->count; i++) {
+        Module* module = table->modules[i];
+        free_ast(&module->allocator, module->ast);
+        mem_free(&module->allocator, module->imports);
+        allocator_free(&module->allocator);
+        free(module);
+    }
+    free(table->modules);
+    free(table->roots);
+    table->modules = NULL;
+    table->roots = NULL;
+    table->count = table->capacity = table->num_roots = 0;
+    pthread_mutex_destroy(&table->lock);
+    pthread_cond_destroy(&table->changed);
+}
+
+// Função para definir o diretório onde os imports são procurados
+void modules_set_search_dir(ModuleTable* table, const char* dir) {
+    snprintf(table->search_dir, sizeof(table->search_dir), "%s", dir);
+}
+
+// Função auxiliar para simplificar um caminho sem consultar o disco: tira os
+// segmentos "." (menos um "./" no início) e resolve "nome/..", para que um
+// mesmo arquivo importado por módulos de diretórios diferentes tenha um só
+// caminho na tabela (e seja executado uma única vez)
+static void normalize_path(char* path) {
+    char copy[MODULE_PATH_MAX];
+    snprintf(copy, sizeof(copy), "%s", path);
+    char* segments[MODULE_PATH_MAX / 2];
+    int count = 0;
+    int absolute = path[0] == '/';
+    char* save = NULL;
+    for (char* segment = strtok_r(copy, "/", &save); segment != NULL; segment = strtok_r(NULL, "/", &save)) {
+        if (strcmp(segment, ".") == 0) {
+            continue;
+        }
+        if (strcmp(segment, "..") == 0) {
+            if (count > 0 && strcmp(segments[count - 1], "..") != 0) {
+                count--;
+                continue;
+            }
+            if (absolute) {
+                continue; // "/.." é a própria raiz
+            }
+        }
+        segments[count++] = segment;
+    }
+
+    char* out = path;
+    if (absolute) {
+        *out++ = '/';
+    } else if (strncmp(path, "./", 2) == 0 && count > 0 && strcmp(segments[0], "..") != 0) {
+        *out++ = '.';
+        *out++ = '/';
+    }
+    for (int i = 0; i < count; i++) {
+        if (i > 0) {
+            *out++ = '/';
+        }
+        size_t length = strlen(segments[i]);
+        memcpy(out, segments[i], length);
+        out += length;
+    }
+    *out = '\0';
+}
+
+// Função para montar o caminho de um import
+int module_resolve(const char* dir, TokenType kind, const char* name, char* path, size_t size) {
+    const char* suffix = kind == TOKEN_IDENTIFIER ? ".ry" : "";
+    int length;
+    if (name[0] == '/' || dir[0] == '\0') {
+        length = snprintf(path, size, "%s%s", name, suffix);
+    } else {
+        length = snprintf(path, size, "%s/%s%s", dir, name, suffix);
+    }
+    if (length < 0 || (size_t)length >= size) {
+        return 0;
+    }
+    normalize_path(path);
+    return 1;
+}
+
+// Função para obter o diretório de um módulo, onde os imports dele são procurados
+void module_dir(const char* path, char* dir, size_t size) {
+    const char* slash = strrchr(path, '/');
+    if (slash == NULL) {
+        snprintf(dir, size, ".");
+    } else if (slash == path) {
+        snprintf(dir, size, "/");
+    } else {
+        snprintf(dir, size, "%.*s", (int)(slash - path), path);
+    }
+}
+
+// Função auxiliar para registrar o erro de um módulo, prefixado pelo caminho
+static void module_fail(Module* module, int line, int column, const char* format, ...) {
+    char message[RODY_ERROR_MAX];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(message, sizeof(message), format, args);
+    va_end(args);
+    error_set(&module->error, line, column, "Em '%s': %s", module->path, message);
+}
+
+// Função auxiliar para pular um comentário (# ... ou #* ... *#)
+static const char* skip_comment(const char* p) {
+    if (p[1] == '*') {
+        const char* end = strstr(p + 2, "*#");
+        return end != NULL ? end + 2 : p + strlen(p);
+    }
+    const char* end = strchr(p, '\n');
+    return end != NULL ? end : p + strlen(p);
+}
+
+// Função auxiliar para ler o nome depois de um "import" e avisar o chamador
+static const char* scan_import_name(const char* p, ImportFound found, void* context) {
+    while (*p != '\0' && (isspace((unsigned char)*p) || *p == '#')) {
+        p = *p == '#' ? skip_comment(p) : p + 1;
+    }
+
+    char name[MODULE_PATH_MAX];
+    TokenType kind;
+    const char* start;
+    const char* end;
+    if (*p == '"') {
+        start = p + 1;
+        end = strchr(start, '"');
+        if (end == NULL) {
+            return start + strlen(start);
+        }
+        kind = TOKEN_STRING;
+        p = end + 1;
+    } else if (isalpha((unsigned char)*p) || *p == '_') {
+        start = p;
+        while (isalnum((unsigned char)*p) || *p == '_') {
+            p++;
+        }
+        end = p;
+        kind = TOKEN_IDENTIFIER;
+    } else {
+        return p;
+    }
+
+    size_t length = (size_t)(end - start);
+    if (length > 0 && length < sizeof(name)) {
+        memcpy(name, start, length);
+        name[length] = '\0';
+        found(context, kind, name);
+    }
+    return p;
+}
+
+// Função auxiliar para encontrar os imports de um fonte sem tokenizá-lo:
+// só strings, comentários e palavras são reconhecidos, e nada é alocado.
+static void prescan(const char* source, ImportFound found, void* context) {
+    const char* p = source;
+    while (*p != '\0') {
+        char c = *p;
+        if (c == '"') {
+            const char* end = strchr(p + 1, '"');
+            p = end != NULL ? end + 1 : p + strlen(p);
+        } else if (c == '#') {
+            p = skip_comment(p);
+        } else if (isalnum((unsigned char)c) || c == '_') {
+            const char* start = p;
+            while (isalnum((unsigned char)*p) || *p == '_') {
+                p++;
+            }
+            if (p - start == 6 && strncmp(start, "import", 6) == 0 && !isdigit((unsigned char)c)) {
+                p = scan_import_name(p, found, context);
+            }
+        } else {
+            p++;
+        }
+    }
+}
+
+static void* worker_main(void* arg);
+
+// Função auxiliar para buscar um módulo pelo caminho ou criá-lo no fim da fila.
+// Deve ser chamada com table->lock travado. Retorna -1 se faltar memória.
+static int find_or_add(ModuleTable* table, const char* path) {
+    for (int i = 0; i < table->count; i++) {
+        if (strcmp(table->modules[i]->path, path) == 0) {
+            return i;
+        }
+    }
+
+    if (table->count == table->capacity) {
+        int capacity = table->capacity == 0 ? 8 : table->capacity * 2;
+        Module** modules = (Module**)realloc(table->modules, capacity * sizeof(Module*));
+        if (modules == NULL) {
+            return -1;
+        }
+        table->modules = modules;
+        table->capacity = capacity;
+    }
+    // Módulos usam malloc: o alocador da instância não é compartilhado entre threads
+    Module* module = (Module*)calloc(1, sizeof(Module));
+    if (module == NULL) {
+        return -1;
+    }
+    snprintf(module->path, sizeof(module->path), "%s", path);
+    allocator_init(&module->allocator, table->backend);
+    error_init(&module->error);
+    table->modules[table->count++] = module;
+
+    // Uma thread nova por módulo descoberto, até o limite. Ela já nasce com
+    // SIGPROF bloqueado: as amostras do sampler devem cair só na thread do
+    // interpretador, dona da pilha-sombra e das tabelas do tratador.
+    if (table->worker_limit > 0) {
+        sigset_t block;
+        sigset_t previous;
+        sigemptyset(&block);
+        sigaddset(&block, SIGPROF);
+        pthread_sigmask(SIG_BLOCK, &block, &previous);
+        if (pthread_create(&table->workers[table->num_workers], NULL, worker_main, table) == 0) {
+            table->num_workers++;
+            table->worker_limit--;
+        }
+        pthread_sigmask(SIG_SETMASK, &previous, NULL);
+    }
+    pthread_cond_broadcast(&table->changed);
+    return table->count - 1;
+}
+
+// Função auxiliar para resolver um import feito por código de dir e registrá-lo; -1 se falhar
+static int add_import(ModuleTable* table, const char* dir, TokenType kind, const char* name) {
+    char path[MODULE_PATH_MAX];
+    if (!module_resolve(dir, kind, name, path, sizeof(path))) {
+        return -1;
+    }
+    pthread_mutex_lock(&table->lock);
+    int index = find_or_add(table, path);
+    pthread_mutex_unlock(&table->lock);
+    return index;
+}
+
+// Contexto da pré-varredura de um módulo
+typedef struct {
+    ModuleTable* table;
+    Module* module;
+} ImportContext;
+
+// Função auxiliar para registrar um import de um módulo (relativo ao diretório dele)
+static void add_module_import(void* context, TokenType kind, const char* name) {
+    ImportContext* ctx = (ImportContext*)context;
+    char dir[MODULE_PATH_MAX];
+    module_dir(ctx->module->path, dir, sizeof(dir));
+    int index = add_import(ctx->table, dir, kind, name);
+    if (index < 0) {
+        return; // O import falhará de novo, com erro, ao ser executado
+    }
+    Module* module = ctx->module;
+    int* imports = (int*)mem_realloc(&module->allocator, MEM_PARSER, module->imports,
+                                     (module->num_imports + 1) * sizeof(int));
+    if (imports == NULL) {
+        return;
+    }
+    module->imports = imports;
+    module->imports[module->num_imports++] = index;
+}
+
+// Função auxiliar para registrar um import do fonte principal
+static void add_root_import(void* context, TokenType kind, const char* name) {
+    ModuleTable* table = (ModuleTable*)context;
+    int index = add_import(table, table->search_dir, kind, name);
+    if (index < 0) {
+        return;
+    }
+    int* roots = (int*)realloc(table->roots, (table->num_roots + 1) * sizeof(int));
+    if (roots == NULL) {
+        return;
+    }
+    table->roots = roots;
+    table->roots[table->num_roots++] = index;
+}
+
+// Função auxiliar para ler o arquivo de um módulo; NULL se não for possível
+static char* read_source(Module* module) {
+    FILE* file = fopen(module->path, "r");
+    if (file == NULL) {
+        return NULL;
+    }
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char* source = length >= 0 ? (char*)mem_alloc(&module->allocator, MEM_LEXER, (size_t)length + 1) : NULL;
+    if (source != NULL) {
+        length = (long)fread(source, 1, (size_t)length, file);
+        source[length] = '\0';
+    }
+    fclose(file);
+    return source;
+}
+
+// Função auxiliar para ler, pré-varrer e analisar um módulo.
+// Só a thread que tirou o módulo da fila mexe nele até o fim.
+static void load_module(ModuleTable* table, Module* module) {
+    TraceRing* trace = table->tracer != NULL ? tracer_thread_ring(table->tracer) : NULL;
+    long long start_ns = trace != NULL ? trace_now() : 0;
+
+    char* source = read_source(module);
+    if (source == NULL) {
+        module_fail(module, 0, 0, "Não foi possível abrir o módulo.");
+        return;
+    }
+
+    // Os imports do módulo entram na fila antes da análise, para as outras threads
+    ImportContext context = { table, module };
+    prescan(source, add_module_import, &context);
+
+    Lexer lexer;
+    lexer_init(&lexer, source, &module->allocator);
+    Parser parser;
+    parser_init(&parser, &lexer);
+    module->ast = parse(&parser);
+    if (module->ast == NULL) {
+        module_fail(module, parser.error.line, parser.error.column, "%s", parser.error.message);
+    }
+    // Os tokens guardam cópias dos lexemas, então o fonte já pode ser liberado
+    mem_free(&module->allocator, source);
+
+    trace_span(trace, "import", "compilacao", start_ns, trace_now(), module->path);
+}
+
+// Função auxiliar que consome a fila até não haver mais módulos nem threads ativas
+static void drain(ModuleTable* table) {
+    pthread_mutex_lock(&table->lock);
+    for (;;) {
+        if (table->next_job < table->count) {
+            Module* module = table->modules[table->next_job++];
+            table->active++;
+            pthread_mutex_unlock(&table->lock);
+            load_module(table, module);
+            pthread_mutex_lock(&table->lock);
+            table->active--;
+            pthread_cond_broadcast(&table->changed);
+        } else if (table->active == 0) {
+            break;
+        } else {
+            // Uma thread ativa ainda pode descobrir novos imports
+            pthread_cond_wait(&table->changed, &table->lock);
+        }
+    }
+    pthread_mutex_unlock(&table->lock);
+}
+
+// Função executada por cada thread de análise
+static void* worker_main(void* arg) {
+    drain((ModuleTable*)arg);
+    return NULL;
+}
+
+// Função para iniciar a carga dos imports de um fonte
+void modules_begin(ModuleTable* table, const char* source) {
+    int threads = table->threads;
+    if (threads <= 0) {
+        threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if (threads > MODULE_THREADS_MAX) {
+        threads = MODULE_THREADS_MAX;
+    }
+    // A thread do chamador também analisa, em modules_wait
+    table->worker_limit = threads > 1 ? threads - 1 : 0;
+    table->num_workers = 0;
+    table->num_roots = 0;
+    prescan(source, add_root_import, table);
+}
+
+// Função auxiliar para recalcular a soma dos contadores dos módulos (--mem-stats).
+// Só roda sem threads de análise ativas, então lê os alocadores sem travas.
+static void update_stats(ModuleTable* table) {
+    allocator_init(&table->stats, table->backend);
+    for (int i = 0; i < table->count; i++) {
+        mem_stats_merge(&table->stats, &table->modules[i]->allocator);
+    }
+}
+
+// Função para esperar a análise de todos os módulos descobertos
+void modules_wait(ModuleTable* table) {
+    drain(table);
+    pthread_mutex_lock(&table->lock);
+    table->worker_limit = 0;
+    int num_workers = table->num_workers;
+    pthread_mutex_unlock(&table->lock);
+    for (int i = 0; i < num_workers; i++) {
+        pthread_join(table->workers[i], NULL);
+    }
+    table->num_workers = 0;
+    update_stats(table);
+}
+
+// Função auxiliar da ordenação por dependência; retorna 0 se o módulo ou
+// alguma dependência faz parte de um ciclo. Todas as dependências são
+// visitadas, para que todos os ciclos fiquem registrados. Erros de leitura e
+// análise não contam aqui: a pré-varredura também vê imports em trechos que
+// podem nunca rodar, então eles só são levantados quando o import executa.
+static int link_visit(ModuleTable* table, int index, RodyError* error) {
+    Module* module = table->modules[index];
+    if (module->link_state == 1) {
+        // Um erro de leitura ou análise do módulo dá lugar ao do ciclo
+        if (!module->circular) {
+            module->circular = 1;
+            error_init(&module->error);
+            module_fail(module, 0, 0, "Importação circular.");
+        }
+        error_set(error, 0, 0, "%s", module->error.message);
+        return 0;
+    }
+    if (module->link_state == 2) {
+        return module->circular == 0;
+    }
+
+    module->link_state = 1;
+    int ok = 1;
+    for (int i = 0; i < module->num_imports; i++) {
+        if (!link_visit(table, module->imports[i], error)) {
+            ok = 0;
+        }
+    }
+    module->link_state = 2;
+    return ok && !module->circular;
+}
+
+// Função para verificar os módulos importados em ordem de dependência
+int modules_link(ModuleTable* table, RodyError* error) {
+    for (int i = 0; i < table->count; i++) {
+        table->modules[i]->link_state = 0;
+    }
+    int ok = 1;
+    for (int i = 0; i < table->num_roots; i++) {
+        if (!link_visit(table, table->roots[i], error)) {
+            ok = 0;
+        }
+    }
+    return ok;
+}
+
+// Função para obter um módulo já carregado, ou carregá-lo agora
+Module* modules_get(ModuleTable* table, const char* importer, TokenType kind, const char* name) {
+    char dir[MODULE_PATH_MAX];
+    if (importer != NULL) {
+        module_dir(importer, dir, sizeof(dir));
+    } else {
+        snprintf(dir, sizeof(dir), "%s", table->search_dir);
+    }
+    int index = add_import(table, dir, kind, name);
+    if (index < 0) {
+        return NULL;
+    }
+    // Se a pré-varredura não viu este import, ele (e seus imports) é analisado aqui
+    drain(table);
+    update_stats(table);
+    return table->modules[index];
+}
@@ -0,0 +1,215 @@
+
+/* output.c */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <unistd.h>
+#include "output.h"
+
+// Cores aceitas pelo print e suas sequências ANSI pré-calculadas
+typedef struct {
+    const char* name;
+    const char* sequence;
+    size_t length;
+} OutputColor;
+
+#define COLOR(name, seq) { name, seq, sizeof(seq) - 1 }
+static const OutputColor colors[] = {
+    COLOR("reset", "\x1b[0m"),
+    COLOR("bold", "\x1b[1m"),
+    COLOR("black", "\x1b[30m"),
+    COLOR("red", "\x1b[31m"),
+    COLOR("green", "\x1b[32m"),
+    COLOR("yellow", "\x1b[33m"),
+    COLOR("blue", "\x1b[34m"),
+    COLOR("magenta", "\x1b[35m"),
+    COLOR("cyan", "\x1b[36m"),
+    COLOR("white", "\x1b[37m"),
+};
+#undef COLOR
+
+// Pares de dígitos "00".."99" para converter inteiros dois a dois
+static const char digit_pairs[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+// Função para inicializar o buffer de saída para um descritor
+void output_init(OutputBuffer* out, int fd, Allocator* allocator) {
+    out->fd = fd;
+    out->data = NULL;
+    out->length = 0;
+    out->line_buffered = 0;
+    out->colors = isatty(fd);
+    out->failed = 0;
+    out->allocator = allocator;
+}
+
+// Função para descarregar e liberar o buffer
+void output_free(OutputBuffer* out) {
+    output_flush(out);
+    mem_free(out->allocator, out->data);
+    out->data = NULL;
+}
+
+// Função para trocar o descritor de destino (descarrega o anterior)
+void output_set_fd(OutputBuffer* out, int fd, int line_buffered) {
+    output_flush(out);
+    out->fd = fd;
+    out->line_buffered = line_buffered;
+    out->colors = isatty(fd);
+    out->failed = 0;
+}
+
+// Função auxiliar para escrever tudo, tratando escritas parciais
+static void write_all(OutputBuffer* out, const char* data, size_t length) {
+    while (length > 0 && !out->failed) {
+        ssize_t written = write(out->fd, data, length);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            out->failed = 1;
+            return;
+        }
+        data += written;
+        length -= (size_t)written;
+    }
+}
+
+// Função para escrever o conteúdo pendente no descritor
+void output_flush(OutputBuffer* out) {
+    if (out->length > 0) {
+        write_all(out, out->data, out->length);
+        out->length = 0;
+    }
+}
+
+// Função auxiliar para garantir o buffer alocado; 0 se faltar memória
+static int ensure_buffer(OutputBuffer* out) {
+    if (out->data == NULL) {
+        out->data = (char*)mem_alloc(out->allocator, MEM_OUTPUT, OUTPUT_BUFFER_SIZE);
+    }
+    return out->data != NULL;
+}
+
+// Função para escrever bytes no buffer
+void output_write(OutputBuffer* out, const char* data, size_t length) {
+    if (!ensure_buffer(out)) {
+        write_all(out, data, length); // Sem buffer, escreve direto
+        return;
+    }
+    if (out->length + length > OUTPUT_BUFFER_SIZE) {
+        output_flush(out);
+        if (length > OUTPUT_BUFFER_SIZE) {
+            write_all(out, data, length);
+            return;
+        }
+    }
+    memcpy(out->data + out->length, data, length);
+    out->length += length;
+}
+
+// Função para escrever um caractere no buffer
+void output_char(OutputBuffer* out, char c) {
+    if (out->data != NULL && out->length < OUTPUT_BUFFER_SIZE) {
+        out->data[out->length++] = c;
+        return;
+    }
+    output_write(out, &c, 1);
+}
+
+// Função para escrever uma quebra de linha (descarrega no modo de linha)
+void output_newline(OutputBuffer* out) {
+    output_char(out, '\n');
+    if (out->line_buffered) {
+        output_flush(out);
+    }
+}
+
+// Função auxiliar para converter um inteiro sem sinal; retorna o início em buffer
+static char* format_unsigned(unsigned long long value, char* end) {
+    char* p = end;
+    while (value >= 100) {
+        unsigned int pair = (unsigned int)(value % 100) * 2;
+        value /= 100;
+        *--p = digit_pairs[pair + 1];
+        *--p = digit_pairs[pair];
+    }
+    if (value >= 10) {
+        unsigned int pair = (unsigned int)value * 2;
+        *--p = digit_pairs[pair + 1];
+        *--p = digit_pairs[pair];
+    } else {
+        *--p = (char)('0' + value);
+    }
+    return p;
+}
+
+// Função para escrever um inteiro sem passar por printf
+void output_int(OutputBuffer* out, long long value) {
+    char buffer[24];
+    char* end = buffer + sizeof(buffer);
+    unsigned long long magnitude = value < 0 ? (unsigned long long)(-(value + 1)) + 1 : (unsigned long long)value;
+    char* start = format_unsigned(magnitude, end);
+    if (value < 0) {
+        *--start = '-';
+    }
+    output_write(out, start, (size_t)(end - start));
+}
+
+// Função para escrever um float com até 6 casas decimais, sem zeros à direita.
+// Valores muito grandes, infinitos ou NaN usam snprintf.
+void output_float(OutputBuffer* out, double value) {
+    char buffer[48];
+    if (!isfinite(value) || fabs(value) >= 1e15) {
+        int length = snprintf(buffer, sizeof(buffer), "%g", value);
+        output_write(out, buffer, (size_t)length);
+        return;
+    }
+
+    int negative = value < 0;
+    double magnitude = negative ? -value : value;
+    unsigned long long scaled = (unsigned long long)(magnitude * 1e6 + 0.5);
+    unsigned long long integer = scaled / 1000000ULL;
+    unsigned int fraction = (unsigned int)(scaled % 1000000ULL);
+
+    char* end = buffer + sizeof(buffer);
+    char* p = end;
+    // Parte fracionária: pelo menos uma casa, sem zeros à direita
+    int digits = 6;
+    while (digits > 1 && fraction % 10 == 0) {
+        fraction /= 10;
+        digits--;
+    }
+    for (int i = 0; i < digits; i++) {
+        *--p = (char)('0' + fraction % 10);
+        fraction /= 10;
+    }
+    *--p = '.';
+    p = format_unsigned(integer, p);
+    if (negative && scaled != 0) {
+        *--p = '-';
+    }
+    output_write(out, p, (size_t)(end - p));
+}
+
+// Função para obter o índice de uma cor pelo nome; -1 se desconhecida
+int output_color_index(const char* name) {
+    for (size_t i = 0; i < sizeof(colors) / sizeof(colors[0]); i++) {
+        if (strcmp(colors[i].name, name) == 0) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+// Função para escrever a sequência ANSI de uma cor (ignorada fora de terminais)
+void output_color(OutputBuffer* out, int color) {
+    if (!out->colors || color < 0 || color >= (int)(sizeof(colors) / sizeof(colors[0]))) {
+        return;
+    }
+    output_write(out, colors[color].sequence, colors[color].length);
+}
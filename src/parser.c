@@ -4,37 +4,66 @@
 #include <stdlib.h>
 #include <string.h>
 #include "parser.h"
+#include "output.h"
+
+// Função auxiliar para registrar um erro de sintaxe na posição do token atual
+static void syntax_error(Parser* parser, const char* message) {
+    Token* token = &parser->current_token;
+    if (token->type == TOKEN_ERROR) {
+        error_set(&parser->error, token->line, token->column,
+                  "Erro léxico na linha %d, coluna %d: %s", token->line, token->column, token->lexeme);
+        return;
+    }
+    error_set(&parser->error, token->line, token->column,
+              "Erro de sintaxe na linha %d, coluna %d: %s Token inesperado: '%s'",
+              token->line, token->column, message, token->lexeme != NULL ? token->lexeme : "(null)");
+}
 
 // Função auxiliar para criar um novo nó AST
-static ASTNode* new_ast_node(NodeType type, Token token) {
-    ASTNode* node = (ASTNode*)malloc(sizeof(ASTNode));
+// Em caso de falha o token é liberado e NULL é retornado
+static ASTNode* new_ast_node(Parser* parser, NodeType type, Token token) {
+    ASTNode* node = (ASTNode*)mem_alloc(parser->allocator, MEM_PARSER, sizeof(ASTNode));
     if (node == NULL) {
-        fprintf(stderr, "Erro: Falha na alocação de memória para ASTNode.\n");
-        exit(1);
+        error_set(&parser->error, token.line, token.column, "Erro: Falha na alocação de memória para ASTNode.");
+        token_free(parser->allocator, &token);
+        return NULL;
     }
     node->type = type;
     node->token = token;
     node->children = NULL;
     node->num_children = 0;
+    node->flags = 0;
     return node;
 }
 
 // Função para adicionar um filho a um nó AST
-static void add_child(ASTNode* parent, ASTNode* child) {
-    parent->num_children++;
-    parent->children = (ASTNode**)realloc(parent->children, parent->num_children * sizeof(ASTNode*));
-    if (parent->children == NULL) {
-        fprintf(stderr, "Erro: Falha na realocação de memória para filhos da AST.\n");
-        exit(1);
+// Retorna 0 em caso de falha (o filho continua pertencendo ao chamador)
+static int add_child(Parser* parser, ASTNode* parent, ASTNode* child) {
+    int count = parent->num_children;
+    // A capacidade dobra quando a contagem chega a uma potência de 2 (1, 2, 4, 8...)
+    if ((count & (count - 1)) == 0) {
+        int capacity = count == 0 ? 1 : count * 2;
+        ASTNode** children = (ASTNode**)mem_realloc(parser->allocator, MEM_PARSER, parent->children,
+                                                       capacity * sizeof(ASTNode*));
+        if (children == NULL) {
+            error_set(&parser->error, child->token.line, child->token.column,
+                      "Erro: Falha na realocação de memória para filhos da AST.");
+            return 0;
+        }
+        parent->children = children;
     }
-    parent->children[parent->num_children - 1] = child;
+    parent->children[parent->num_children++] = child;
+    return 1;
 }
 
 // Função para inicializar o parser
 void parser_init(Parser* parser, Lexer* lexer) {
     parser->lexer = lexer;
+    parser->allocator = lexer->allocator;
+    error_init(&parser->error);
     // Pega o primeiro token
     parser->current_token = lexer_next_token(lexer);
+    parser->previous_token = parser->current_token;
 }
 
 // Função auxiliar para avançar para o próximo token
@@ -49,62 +78,316 @@ static int check(Parser* parser, TokenType type) {
 }
 
 // Função auxiliar para consumir um token do tipo esperado, ou reportar erro
+// Em caso de erro retorna um token vazio e registra o erro em parser->error
 static Token consume(Parser* parser, TokenType type, const char* message) {
     if (check(parser, type)) {
         Token token = parser->current_token;
         advance_parser(parser);
         return token;
-    } else {
-        fprintf(stderr, "Erro de sintaxe na linha %d, coluna %d: %s. Token inesperado: ",
-                parser->current_token.line, parser->current_token.column, message);
-        if (parser->current_token.lexeme != NULL) {
-            fprintf(stderr, "'%s'\n", parser->current_token.lexeme);
-        } else {
-            fprintf(stderr, "(null)\n");
-        }
-        exit(1);
     }
+    syntax_error(parser, message);
+    Token empty = { TOKEN_ERROR, NULL, parser->current_token.line, parser->current_token.column };
+    return empty;
+}
+
+// Função auxiliar para consumir e descartar um token de pontuação
+static int expect(Parser* parser, TokenType type, const char* message) {
+    Token token = consume(parser, type, message);
+    if (parser->error.has_error) {
+        return 0;
+    }
+    token_free(parser->allocator, &token);
+    return 1;
+}
+
+// Função auxiliar para consumir um token opcional; retorna 1 se ele estava presente
+static int match(Parser* parser, TokenType type) {
+    if (!check(parser, type)) {
+        return 0;
+    }
+    token_free(parser->allocator, &parser->current_token);
+    advance_parser(parser);
+    return 1;
+}
+
+// Função auxiliar para montar um nó com dois filhos (operação binária, intervalo, atribuição)
+// Em caso de falha libera os operandos e o token do operador
+static ASTNode* binary_node(Parser* parser, NodeType type, Token operator_token, ASTNode* left, ASTNode* right) {
+    ASTNode* node = new_ast_node(parser, type, operator_token);
+    if (node == NULL) {
+        free_ast(parser->allocator, left);
+        free_ast(parser->allocator, right);
+        return NULL;
+    }
+    if (!add_child(parser, node, left)) {
+        free_ast(parser->allocator, left);
+        free_ast(parser->allocator, right);
+        free_ast(parser->allocator, node);
+        return NULL;
+    }
+    if (!add_child(parser, node, right)) {
+        free_ast(parser->allocator, right);
+        free_ast(parser->allocator, node);
+        return NULL;
+    }
+    return node;
+}
+
+// Função auxiliar para adicionar um filho recém-analisado (que pode ser NULL)
+// Em caso de falha libera o pai e o filho e retorna 0
+static int attach(Parser* parser, ASTNode* parent, ASTNode* child) {
+    if (child == NULL || !add_child(parser, parent, child)) {
+        free_ast(parser->allocator, child);
+        free_ast(parser->allocator, parent);
+        return 0;
+    }
+    return 1;
 }
 
 // Protótipos de funções de parsing
+static ASTNode* range(Parser* parser);
+static ASTNode* comparison(Parser* parser);
 static ASTNode* expression(Parser* parser);
 static ASTNode* term(Parser* parser);
 static ASTNode* factor(Parser* parser);
 static ASTNode* statement(Parser* parser);
+static ASTNode* print_statement(Parser* parser);
+static ASTNode* get_statement(Parser* parser);
+static ASTNode* import_statement(Parser* parser);
+static ASTNode* block(Parser* parser);
+static ASTNode* primary(Parser* parser);
 
-// <factor> ::= INTEGER | FLOAT | STRING | IDENTIFIER | "(" <expression> ")"
-static ASTNode* factor(Parser* parser) {
+// <stage> ::= "." ("map" | "filter") "(" IDENTIFIER ":" <range> ")"
+static ASTNode* stage(Parser* parser) {
+    match(parser, TOKEN_DOT);
+    NodeType type;
+    if (check(parser, TOKEN_IDENTIFIER) && strcmp(parser->current_token.lexeme, "map") == 0) {
+        type = NODE_MAP;
+    } else if (check(parser, TOKEN_IDENTIFIER) && strcmp(parser->current_token.lexeme, "filter") == 0) {
+        type = NODE_FILTER;
+    } else {
+        syntax_error(parser, "Esperado 'map' ou 'filter'.");
+        return NULL;
+    }
+    Token stage_token = parser->current_token;
+    advance_parser(parser);
+    ASTNode* node = new_ast_node(parser, type, stage_token);
+    if (node == NULL) {
+        return NULL;
+    }
+
+    if (!expect(parser, TOKEN_LPAREN, "Esperado '('.")) {
+        free_ast(parser->allocator, node);
+        return NULL;
+    }
+    Token param = consume(parser, TOKEN_IDENTIFIER, "Esperado o nome do parâmetro.");
+    if (parser->error.has_error) {
+        free_ast(parser->allocator, node);
+        return NULL;
+    }
+    if (!attach(parser, node, new_ast_node(parser, NODE_IDENTIFIER, param))) {
+        return NULL;
+    }
+    if (!expect(parser, TOKEN_COLON, "Esperado ':'.")) {
+        free_ast(parser->allocator, node);
+        return NULL;
+    }
+    if (!attach(parser, node, range(parser))) {
+        return NULL;
+    }
+    if (!expect(parser, TOKEN_RPAREN, "Esperado ')'.")) {
+        free_ast(parser->allocator, node);
+        return NULL;
+    }
+    return node;
+}
+
+// Função auxiliar para acrescentar um estágio a uma fonte. Estágios encadeados
+// não se aninham: entram todos no mesmo nó PIPELINE, que a execução percorre
+// numa única passada, sem listas intermediárias.
+static ASTNode* pipeline_stage(Parser* parser, ASTNode* source) {
+    ASTNode* next = stage(parser);
+    if (next == NULL) {
+        free_ast(parser->allocator, source);
+        return NULL;
+    }
+    if (source->type != NODE_PIPELINE) {
+        Token pipe_token = make_token(parser->allocator, TOKEN_DOT, ".", 1, next->token.line, next->token.column);
+        ASTNode* pipeline = new_ast_node(parser, NODE_PIPELINE, pipe_token);
+        if (pipeline == NULL) {
+            free_ast(parser->allocator, next);
+            free_ast(parser->allocator, source);
+            return NULL;
+        }
+        if (!attach(parser, pipeline, source)) {
+            free_ast(parser->allocator, next);
+            return NULL;
+        }
+        source = pipeline;
+    }
+    if (!attach(parser, source, next)) {
+        return NULL;
+    }
+    return source;
+}
+
+// <list> ::= "[" [<range> ("," <range>)*] "]"
+static ASTNode* list_literal(Parser* parser) {
+    ASTNode* node = new_ast_node(parser, NODE_LIST, consume(parser, TOKEN_LBRACKET, "Esperado '['."));
+    if (node == NULL) {
+        return NULL;
+    }
+    if (!check(parser, TOKEN_RBRACKET)) {
+        do {
+            if (!attach(parser, node, range(parser))) {
+                return NULL;
+            }
+        } while (match(parser, TOKEN_COMMA));
+    }
+    if (!expect(parser, TOKEN_RBRACKET, "Esperado ']'.")) {
+        free_ast(parser->allocator, node);
+        return NULL;
+    }
+    return node;
+}
+
+// <dict> ::= "{" [<range> ":" <range> ("," <range> ":" <range>)*] "}"
+// Os filhos alternam chave e valor
+static ASTNode* dict_literal(Parser* parser) {
+    ASTNode* node = new_ast_node(parser, NODE_DICT, consume(parser, TOKEN_LBRACE, "Esperado '{'."));
+    if (node == NULL) {
+        return NULL;
+    }
+    if (!check(parser, TOKEN_RBRACE)) {
+        do {
+            if (!attach(parser, node, range(parser))) {
+                return NULL;
+            }
+            if (!expect(parser, TOKEN_COLON, "Esperado ':'.")) {
+                free_ast(parser->allocator, node);
+                return NULL;
+            }
+            if (!attach(parser, node, range(parser))) {
+                return NULL;
+            }
+        } while (match(parser, TOKEN_COMMA));
+    }
+    if (!expect(parser, TOKEN_RBRACE, "Esperado '}'.")) {
+        free_ast(parser->allocator, node);
+        return NULL;
+    }
+    return node;
+}
+
+// <load> ::= "load" <primary>
+// O filho é o caminho do arquivo gravado com save
+static ASTNode* load_expression(Parser* parser) {
+    ASTNode* node = new_ast_node(parser, NODE_FILE_READ, consume(parser, TOKEN_LOAD, "Esperado 'load'."));
+    if (node == NULL) {
+        return NULL;
+    }
+    if (!attach(parser, node, primary(parser))) {
+        return NULL;
+    }
+    return node;
+}
+
+// <call> ::= IDENTIFIER "(" [<range> ("," <range>)*] ")"
+// Recebe o identificador já analisado; os filhos são os argumentos
+static ASTNode* call_arguments(Parser* parser, ASTNode* node) {
+    node->type = NODE_FUN_CALL;
+    expect(parser, TOKEN_LPAREN, "Esperado '('.");
+    if (!check(parser, TOKEN_RPAREN)) {
+        do {
+            if (!attach(parser, node, range(parser))) {
+                return NULL;
+            }
+        } while (match(parser, TOKEN_COMMA));
+    }
+    if (!expect(parser, TOKEN_RPAREN, "Esperado ')'.")) {
+        free_ast(parser->allocator, node);
+        return NULL;
+    }
+    return node;
+}
+
+// <primary> ::= INTEGER | FLOAT | STRING | IDENTIFIER | <call> | <list> | <dict> | <load> | "(" <range> ")"
+static ASTNode* primary(Parser* parser) {
     if (check(parser, TOKEN_INTEGER)) {
-        return new_ast_node(NODE_INTEGER, consume(parser, TOKEN_INTEGER, "Esperado um inteiro."));
+        return new_ast_node(parser, NODE_INTEGER, consume(parser, TOKEN_INTEGER, "Esperado um inteiro."));
     } else if (check(parser, TOKEN_FLOAT)) {
-        return new_ast_node(NODE_FLOAT, consume(parser, TOKEN_FLOAT, "Esperado um float."));
+        return new_ast_node(parser, NODE_FLOAT, consume(parser, TOKEN_FLOAT, "Esperado um float."));
     } else if (check(parser, TOKEN_STRING)) {
-        return new_ast_node(NODE_STRING, consume(parser, TOKEN_STRING, "Esperado uma string."));
+        return new_ast_node(parser, NODE_STRING, consume(parser, TOKEN_STRING, "Esperado uma string."));
     } else if (check(parser, TOKEN_IDENTIFIER)) {
-        return new_ast_node(NODE_IDENTIFIER, consume(parser, TOKEN_IDENTIFIER, "Esperado um identificador."));
+        ASTNode* node = new_ast_node(parser, NODE_IDENTIFIER, consume(parser, TOKEN_IDENTIFIER, "Esperado um identificador."));
+        if (node != NULL && check(parser, TOKEN_LPAREN)) {
+            return call_arguments(parser, node);
+        }
+        return node;
+    } else if (check(parser, TOKEN_LBRACKET)) {
+        return list_literal(parser);
+    } else if (check(parser, TOKEN_LBRACE)) {
+        return dict_literal(parser);
+    } else if (check(parser, TOKEN_LOAD)) {
+        return load_expression(parser);
     } else if (check(parser, TOKEN_LPAREN)) {
-        consume(parser, TOKEN_LPAREN, "Esperado '('.");
-        ASTNode* expr = expression(parser);
-        consume(parser, TOKEN_RPAREN, "Esperado ')'.");
+        expect(parser, TOKEN_LPAREN, "Esperado '('.");
+        ASTNode* expr = range(parser);
+        if (expr == NULL) {
+            return NULL;
+        }
+        if (!expect(parser, TOKEN_RPAREN, "Esperado ')'.")) {
+            free_ast(parser->allocator, expr);
+            return NULL;
+        }
         return expr;
     }
-    fprintf(stderr, "Erro de sintaxe na linha %d, coluna %d: Esperado um fator.\n",
-            parser->current_token.line, parser->current_token.column);
-    exit(1);
+    syntax_error(parser, "Esperado um fator.");
+    return NULL;
+}
+
+// Função auxiliar para aplicar um acesso "[" <range> "]" a um valor
+static ASTNode* index_access(Parser* parser, ASTNode* target) {
+    Token bracket = parser->current_token;
+    advance_parser(parser);
+    ASTNode* index = range(parser);
+    if (index == NULL) {
+        token_free(parser->allocator, &bracket);
+        free_ast(parser->allocator, target);
+        return NULL;
+    }
+    ASTNode* node = binary_node(parser, NODE_INDEX, bracket, target, index);
+    if (node != NULL && !expect(parser, TOKEN_RBRACKET, "Esperado ']'.")) {
+        free_ast(parser->allocator, node);
+        return NULL;
+    }
+    return node;
+}
+
+// <factor> ::= <primary> (<stage> | "[" <range> "]")*
+static ASTNode* factor(Parser* parser) {
+    ASTNode* node = primary(parser);
+    while (node != NULL && (check(parser, TOKEN_DOT) || check(parser, TOKEN_LBRACKET))) {
+        node = check(parser, TOKEN_DOT) ? pipeline_stage(parser, node) : index_access(parser, node);
+    }
+    return node;
 }
 
-// <term> ::= <factor> (("+" | "-") <factor>)*
+// <term> ::= <factor> (("*" | "/") <factor>)*
 static ASTNode* term(Parser* parser) {
     ASTNode* node = factor(parser);
 
-    while (check(parser, TOKEN_PLUS) || check(parser, TOKEN_MINUS)) {
+    while (node != NULL && (check(parser, TOKEN_MULTIPLY) || check(parser, TOKEN_DIVIDE))) {
         Token operator_token = parser->current_token;
         advance_parser(parser);
         ASTNode* right = factor(parser);
-        ASTNode* binary_op_node = new_ast_node(NODE_BINARY_OP, operator_token);
-        add_child(binary_op_node, node);
-        add_child(binary_op_node, right);
-        node = binary_op_node;
+        if (right == NULL) {
+            token_free(parser->allocator, &operator_token);
+            free_ast(parser->allocator, node);
+            return NULL;
+        }
+        node = binary_node(parser, NODE_BINARY_OP, operator_token, node, right);
     }
     return node;
 }
@@ -113,54 +396,491 @@ static ASTNode* term(Parser* parser) {
 static ASTNode* expression(Parser* parser) {
     ASTNode* node = term(parser);
 
-    while (check(parser, TOKEN_MULTIPLY) || check(parser, TOKEN_DIVIDE)) {
+    while (node != NULL && (check(parser, TOKEN_PLUS) || check(parser, TOKEN_MINUS))) {
         Token operator_token = parser->current_token;
         advance_parser(parser);
         ASTNode* right = term(parser);
-        ASTNode* binary_op_node = new_ast_node(NODE_BINARY_OP, operator_token);
-        add_child(binary_op_node, node);
-        add_child(binary_op_node, right);
-        node = binary_op_node;
+        if (right == NULL) {
+            token_free(parser->allocator, &operator_token);
+            free_ast(parser->allocator, node);
+            return NULL;
+        }
+        node = binary_node(parser, NODE_BINARY_OP, operator_token, node, right);
+    }
+    return node;
+}
+
+// <comparison> ::= <expression> [("==" | "!=" | "<" | ">" | "<=" | ">=") <expression>]
+static ASTNode* comparison(Parser* parser) {
+    ASTNode* node = expression(parser);
+    // O lexer sempre lê "<-" como a seta do for, então "x<-1" não é "x < -1"
+    // (e não há menos unário): o erro diz isso em vez de um "Esperado '{'" adiante
+    if (node != NULL && check(parser, TOKEN_ARROW_LEFT)) {
+        syntax_error(parser, "'<-' só é usado no for; para comparar com um negativo, escreva 'x < 0 - 1'.");
+        free_ast(parser->allocator, node);
+        return NULL;
+    }
+    if (node != NULL && (check(parser, TOKEN_EQ) || check(parser, TOKEN_NEQ) || check(parser, TOKEN_LT) ||
+                         check(parser, TOKEN_GT) || check(parser, TOKEN_LE) || check(parser, TOKEN_GE))) {
+        Token operator_token = parser->current_token;
+        advance_parser(parser);
+        ASTNode* right = expression(parser);
+        if (right == NULL) {
+            token_free(parser->allocator, &operator_token);
+            free_ast(parser->allocator, node);
+            return NULL;
+        }
+        node = binary_node(parser, NODE_BINARY_OP, operator_token, node, right);
     }
     return node;
 }
 
-// <statement> ::= <expression> ";"
+// <range> ::= <comparison> [".." <comparison>]
+// O intervalo é semiaberto: 0..3 produz 0, 1 e 2
+static ASTNode* range(Parser* parser) {
+    ASTNode* node = comparison(parser);
+    if (node != NULL && check(parser, TOKEN_RANGE)) {
+        Token range_token = parser->current_token;
+        advance_parser(parser);
+        ASTNode* end = comparison(parser);
+        if (end == NULL) {
+            token_free(parser->allocator, &range_token);
+            free_ast(parser->allocator, node);
+            return NULL;
+        }
+        node = binary_node(parser, NODE_RANGE, range_token, node, end);
+    }
+    return node;
+}
+
+// <print_item> ::= "br" | "tab" | "color" (IDENTIFIER | STRING) | <range>
+static ASTNode* print_item(Parser* parser) {
+    if (check(parser, TOKEN_BR) || check(parser, TOKEN_TAB)) {
+        Token token = parser->current_token;
+        advance_parser(parser);
+        return new_ast_node(parser, NODE_PRINT_FORMAT, token);
+    }
+    if (!check(parser, TOKEN_COLOR)) {
+        return range(parser);
+    }
+
+    ASTNode* node = new_ast_node(parser, NODE_PRINT_FORMAT, consume(parser, TOKEN_COLOR, "Esperado 'color'."));
+    if (node == NULL) {
+        return NULL;
+    }
+    if (!check(parser, TOKEN_IDENTIFIER) && !check(parser, TOKEN_STRING)) {
+        syntax_error(parser, "Esperado o nome de uma cor.");
+        free_ast(parser->allocator, node);
+        return NULL;
+    }
+    // O nome é validado aqui para que a execução só precise consultar a tabela
+    if (output_color_index(parser->current_token.lexeme) < 0) {
+        syntax_error(parser, "Cor desconhecida.");
+        free_ast(parser->allocator, node);
+        return NULL;
+    }
+    Token name = parser->current_token;
+    advance_parser(parser);
+    ASTNode* name_node = new_ast_node(parser, NODE_STRING, name);
+    if (name_node == NULL || !add_child(parser, node, name_node)) {
+        free_ast(parser->allocator, name_node);
+        free_ast(parser->allocator, node);
+        return NULL;
+    }
+    return node;
+}
+
+// <print_stmt> ::= "print" <print_item> ("," <print_item>)* ";"
+static ASTNode* print_statement(Parser* parser) {
+    ASTNode* node = new_ast_node(parser, NODE_PRINT_STMT, consume(parser, TOKEN_PRINT, "Esperado 'print'."));
+    if (node == NULL) {
+        return NULL;
+    }
+    do {
+        ASTNode* item = print_item(parser);
+        if (item == NULL) {
+            free_ast(parser->allocator, node);
+            return NULL;
+        }
+        if (!add_child(parser, node, item)) {
+            free_ast(parser->allocator, item);
+            free_ast(parser->allocator, node);
+            return NULL;
+        }
+    } while (match(parser, TOKEN_COMMA));
+
+    if (!expect(parser, TOKEN_SEMICOLON, "Esperado ';'.")) {
+        free_ast(parser->allocator, node);
+        return NULL;
+    }
+    return node;
+}
+
+// <get_stmt> ::= "get" ["int" | "float" | "string"] IDENTIFIER ["," (<expression> | "*")] ";"
+// O token do nó é o tipo pedido (ou o próprio "get", sem tipo); o segundo filho,
+// quando presente, é a quantidade de linhas do lote ("*" lê toda a entrada).
+static ASTNode* get_statement(Parser* parser) {
+    Token get_token = consume(parser, TOKEN_GET, "Esperado 'get'.");
+    Token type_token = get_token;
+    if (check(parser, TOKEN_TYPE_INT) || check(parser, TOKEN_TYPE_FLOAT) || check(parser, TOKEN_TYPE_STRING)) {
+        token_free(parser->allocator, &get_token);
+        type_token = parser->current_token;
+        advance_parser(parser);
+    }
+    ASTNode* node = new_ast_node(parser, NODE_GET_STMT, type_token);
+    if (node == NULL) {
+        return NULL;
+    }
+
+    Token name = consume(parser, TOKEN_IDENTIFIER, "Esperado o nome da variável.");
+    ASTNode* name_node = parser->error.has_error ? NULL : new_ast_node(parser, NODE_IDENTIFIER, name);
+    if (name_node == NULL || !add_child(parser, node, name_node)) {
+        free_ast(parser->allocator, name_node);
+        free_ast(parser->allocator, node);
+        return NULL;
+    }
+
+    if (match(parser, TOKEN_COMMA)) {
+        // Em lote o resultado é texto; conversão numérica só linha a linha
+        if (node->token.type == TOKEN_TYPE_INT || node->token.type == TOKEN_TYPE_FLOAT) {
+            syntax_error(parser, "Leitura em lote só é aceita para string.");
+            free_ast(parser->allocator, node);
+            return NULL;
+        }
+        if (match(parser, TOKEN_MULTIPLY)) {
+            node->flags |= NODE_FLAG_GET_ALL;
+        } else {
+            ASTNode* count = expression(parser);
+            if (count == NULL || !add_child(parser, node, count)) {
+                free_ast(parser->allocator, count);
+                free_ast(parser->allocator, node);
+                return NULL;
+            }
+        }
+    }
+
+    if (!expect(parser, TOKEN_SEMICOLON, "Esperado ';'.")) {
+        free_ast(parser->allocator, node);
+        return NULL;
+    }
+    return node;
+}
+
+// <import_stmt> ::= "import" (IDENTIFIER | STRING) ";"
+// O token do nó é o nome do módulo (identificador: nome.ry; string: caminho)
+static ASTNode* import_statement(Parser* parser) {
+    if (!expect(parser, TOKEN_IMPORT, "Esperado 'import'.")) {
+        return NULL;
+    }
+    if (!check(parser, TOKEN_IDENTIFIER) && !check(parser, TOKEN_STRING)) {
+        syntax_error(parser, "Esperado o nome do módulo.");
+        return NULL;
+    }
+    Token name = parser->current_token;
+    advance_parser(parser);
+    ASTNode* node = new_ast_node(parser, NODE_IMPORT, name);
+    if (node == NULL) {
+        return NULL;
+    }
+    if (!expect(parser, TOKEN_SEMICOLON, "Esperado ';'.")) {
+        free_ast(parser->allocator, node);
+        return NULL;
+    }
+    return node;
+}
+
+// <save_stmt> ::= "save" <range> "->" <range> ";"
+// Filhos: o valor e o caminho do arquivo
+static ASTNode* save_statement(Parser* parser) {
+    ASTNode* node = new_ast_node(parser, NODE_FILE_WRITE, consume(parser, TOKEN_SAVE, "Esperado 'save'."));
+    if (node == NULL) {
+        return NULL;
+    }
+    if (!attach(parser, node, range(parser))) {
+        return NULL;
+    }
+    if (!expect(parser, TOKEN_ARROW_RIGHT, "Esperado '->'.")) {
+        free_ast(parser->allocator, node);
+        return NULL;
+    }
+    if (!attach(parser, node, range(parser))) {
+        return NULL;
+    }
+    if (!expect(parser, TOKEN_SEMICOLON, "Esperado ';'.")) {
+        free_ast(parser->allocator, node);
+        return NULL;
+    }
+    return node;
+}
+
+// <block> ::= "{" <statement>* "}"
+static ASTNode* block(Parser* parser) {
+    ASTNode* node = new_ast_node(parser, NODE_BLOCK, consume(parser, TOKEN_LBRACE, "Esperado '{'."));
+    if (node == NULL) {
+        return NULL;
+    }
+    while (!check(parser, TOKEN_RBRACE) && !check(parser, TOKEN_EOF)) {
+        if (!attach(parser, node, statement(parser))) {
+            return NULL;
+        }
+    }
+    if (!expect(parser, TOKEN_RBRACE, "Esperado '}'.")) {
+        free_ast(parser->allocator, node);
+        return NULL;
+    }
+    return node;
+}
+
+// <for_stmt> ::= "for" IDENTIFIER "<-" <range> <block>
+// A fonte é um intervalo, uma lista ou um pipeline de map/filter
+static ASTNode* for_statement(Parser* parser) {
+    ASTNode* node = new_ast_node(parser, NODE_FOR_STMT, consume(parser, TOKEN_FOR, "Esperado 'for'."));
+    if (node == NULL) {
+        return NULL;
+    }
+    Token name = consume(parser, TOKEN_IDENTIFIER, "Esperado o nome da variável.");
+    if (parser->error.has_error) {
+        free_ast(parser->allocator, node);
+        return NULL;
+    }
+    if (!attach(parser, node, new_ast_node(parser, NODE_IDENTIFIER, name))) {
+        return NULL;
+    }
+    if (!expect(parser, TOKEN_ARROW_LEFT, "Esperado '<-'.")) {
+        free_ast(parser->allocator, node);
+        return NULL;
+    }
+    if (!attach(parser, node, range(parser)) || !attach(parser, node, block(parser))) {
+        return NULL;
+    }
+    return node;
+}
+
+// <loop_stmt> ::= "loop" <range> <block>
+// Repete o bloco N vezes, com um contador (sem criar lista)
+static ASTNode* loop_statement(Parser* parser) {
+    ASTNode* node = new_ast_node(parser, NODE_LOOP_STMT, consume(parser, TOKEN_LOOP, "Esperado 'loop'."));
+    if (node == NULL) {
+        return NULL;
+    }
+    if (!attach(parser, node, range(parser)) || !attach(parser, node, block(parser))) {
+        return NULL;
+    }
+    return node;
+}
+
+// <if_stmt> ::= "if" <range> <block> ["else" (<if_stmt> | <block>)]
+// Filhos: condição, bloco e, se houver, o else
+static ASTNode* if_statement(Parser* parser) {
+    ASTNode* node = new_ast_node(parser, NODE_IF_STMT, consume(parser, TOKEN_IF, "Esperado 'if'."));
+    if (node == NULL) {
+        return NULL;
+    }
+    if (!attach(parser, node, range(parser)) || !attach(parser, node, block(parser))) {
+        return NULL;
+    }
+    if (match(parser, TOKEN_ELSE)) {
+        if (!attach(parser, node, check(parser, TOKEN_IF) ? if_statement(parser) : block(parser))) {
+            return NULL;
+        }
+    }
+    return node;
+}
+
+// <fun_decl> ::= "fun" IDENTIFIER "(" [IDENTIFIER ("," IDENTIFIER)*] ")" ["pure"] <block>
+// O token do nó é o nome; os filhos são os parâmetros e, por último, o corpo
+static ASTNode* fun_declaration(Parser* parser) {
+    if (!expect(parser, TOKEN_FUN, "Esperado 'fun'.")) {
+        return NULL;
+    }
+    Token name = consume(parser, TOKEN_IDENTIFIER, "Esperado o nome da função.");
+    if (parser->error.has_error) {
+        return NULL;
+    }
+    ASTNode* node = new_ast_node(parser, NODE_FUN_DECL, name);
+    if (node == NULL) {
+        return NULL;
+    }
+    if (!expect(parser, TOKEN_LPAREN, "Esperado '('.")) {
+        free_ast(parser->allocator, node);
+        return NULL;
+    }
+    if (!check(parser, TOKEN_RPAREN)) {
+        do {
+            Token param = consume(parser, TOKEN_IDENTIFIER, "Esperado o nome do parâmetro.");
+            if (parser->error.has_error) {
+                free_ast(parser->allocator, node);
+                return NULL;
+            }
+            if (!attach(parser, node, new_ast_node(parser, NODE_IDENTIFIER, param))) {
+                return NULL;
+            }
+        } while (match(parser, TOKEN_COMMA));
+    }
+    if (!expect(parser, TOKEN_RPAREN, "Esperado ')'.")) {
+        free_ast(parser->allocator, node);
+        return NULL;
+    }
+    // Atributo opcional: o autor garante que a função é pura
+    if (check(parser, TOKEN_IDENTIFIER) && strcmp(parser->current_token.lexeme, "pure") == 0) {
+        match(parser, TOKEN_IDENTIFIER);
+        node->flags |= NODE_FLAG_PURE;
+    }
+    if (!attach(parser, node, block(parser))) {
+        return NULL;
+    }
+    return node;
+}
+
+// <return_stmt> ::= "return" [<range>] ";"
+static ASTNode* return_statement(Parser* parser) {
+    ASTNode* node = new_ast_node(parser, NODE_RETURN_STMT, consume(parser, TOKEN_RETURN, "Esperado 'return'."));
+    if (node == NULL) {
+        return NULL;
+    }
+    if (!check(parser, TOKEN_SEMICOLON) && !attach(parser, node, range(parser))) {
+        return NULL;
+    }
+    if (!expect(parser, TOKEN_SEMICOLON, "Esperado ';'.")) {
+        free_ast(parser->allocator, node);
+        return NULL;
+    }
+    return node;
+}
+
+// <statement> ::= <print_stmt> | <get_stmt> | <import_stmt> | <for_stmt> | <loop_stmt> | <save_stmt>
+//               | <if_stmt> | <fun_decl> | <return_stmt>
+//               | IDENTIFIER "=" <range> ";" | <range> ";"
 static ASTNode* statement(Parser* parser) {
-    ASTNode* expr_node = expression(parser);
-    consume(parser, TOKEN_SEMICOLON, "Esperado ';'.");
+    if (check(parser, TOKEN_PRINT)) {
+        return print_statement(parser);
+    }
+    if (check(parser, TOKEN_GET)) {
+        return get_statement(parser);
+    }
+    if (check(parser, TOKEN_IMPORT)) {
+        return import_statement(parser);
+    }
+    if (check(parser, TOKEN_FOR)) {
+        return for_statement(parser);
+    }
+    if (check(parser, TOKEN_LOOP)) {
+        return loop_statement(parser);
+    }
+    if (check(parser, TOKEN_SAVE)) {
+        return save_statement(parser);
+    }
+    if (check(parser, TOKEN_IF)) {
+        return if_statement(parser);
+    }
+    if (check(parser, TOKEN_FUN)) {
+        return fun_declaration(parser);
+    }
+    if (check(parser, TOKEN_RETURN)) {
+        return return_statement(parser);
+    }
+    ASTNode* expr_node = range(parser);
+    if (expr_node == NULL) {
+        return NULL;
+    }
+    if (expr_node->type == NODE_IDENTIFIER && check(parser, TOKEN_ASSIGN)) {
+        Token assign_token = parser->current_token;
+        advance_parser(parser);
+        ASTNode* value = range(parser);
+        if (value == NULL) {
+            token_free(parser->allocator, &assign_token);
+            free_ast(parser->allocator, expr_node);
+            return NULL;
+        }
+        expr_node = binary_node(parser, NODE_ASSIGNMENT, assign_token, expr_node, value);
+        if (expr_node == NULL) {
+            return NULL;
+        }
+    }
+    if (!expect(parser, TOKEN_SEMICOLON, "Esperado ';'.")) {
+        free_ast(parser->allocator, expr_node);
+        return NULL;
+    }
     return expr_node;
 }
 
+// Função para obter o nome de um tipo de nó (para relatórios)
+const char* node_type_name(NodeType type) {
+    static const char* const names[NODE_TYPE_COUNT] = {
+        [NODE_PROGRAM] = "PROGRAM",
+        [NODE_VAR_DECL] = "VAR_DECL",
+        [NODE_ASSIGNMENT] = "ASSIGNMENT",
+        [NODE_PRINT_STMT] = "PRINT_STMT",
+        [NODE_GET_STMT] = "GET_STMT",
+        [NODE_IF_STMT] = "IF_STMT",
+        [NODE_WHILE_STMT] = "WHILE_STMT",
+        [NODE_FOR_STMT] = "FOR_STMT",
+        [NODE_LOOP_STMT] = "LOOP_STMT",
+        [NODE_FUN_DECL] = "FUN_DECL",
+        [NODE_FUN_CALL] = "FUN_CALL",
+        [NODE_RETURN_STMT] = "RETURN_STMT",
+        [NODE_SYSTEM_CALL] = "SYSTEM_CALL",
+        [NODE_FILE_READ] = "FILE_READ",
+        [NODE_FILE_WRITE] = "FILE_WRITE",
+        [NODE_FILE_APPEND] = "FILE_APPEND",
+        [NODE_IDENTIFIER] = "IDENTIFIER",
+        [NODE_INTEGER] = "INTEGER",
+        [NODE_FLOAT] = "FLOAT",
+        [NODE_STRING] = "STRING",
+        [NODE_LIST] = "LIST",
+        [NODE_DICT] = "DICT",
+        [NODE_BINARY_OP] = "BINARY_OP",
+        [NODE_UNARY_OP] = "UNARY_OP",
+        [NODE_BLOCK] = "BLOCK",
+        [NODE_WAIT] = "WAIT",
+        [NODE_IMPORT] = "IMPORT",
+        [NODE_PRINT_FORMAT] = "PRINT_FORMAT",
+        [NODE_RANGE] = "RANGE",
+        [NODE_PIPELINE] = "PIPELINE",
+        [NODE_MAP] = "MAP",
+        [NODE_FILTER] = "FILTER",
+        [NODE_INDEX] = "INDEX",
+    };
+    if (type < 0 || type >= NODE_TYPE_COUNT || names[type] == NULL) {
+        return "?";
+    }
+    return names[type];
+}
+
 // Função para liberar a memória da AST
-void free_ast(ASTNode* node) {
+void free_ast(Allocator* allocator, ASTNode* node) {
     if (node == NULL) {
         return;
     }
     for (int i = 0; i < node->num_children; i++) {
-        free_ast(node->children[i]);
-    }
-    if (node->children != NULL) {
-        free(node->children);
-    }
-    // A memória do lexeme do token é gerenciada pelo lexer, exceto para TOKEN_EOF que é uma string literal
-    if (node->token.type != TOKEN_EOF) {
-        token_free(&node->token);
+        free_ast(allocator, node->children[i]);
     }
-    free(node);
+    mem_free(allocator, node->children);
+    token_free(allocator, &node->token);
+    mem_free(allocator, node);
 }
 
 // <program> ::= <statement>* EOF
 ASTNode* parse(Parser* parser) {
-    ASTNode* program_node = new_ast_node(NODE_PROGRAM, make_token(TOKEN_EOF, "", 0, 0, 0)); // Token dummy
+    ASTNode* program_node = new_ast_node(parser, NODE_PROGRAM, make_token(parser->allocator, TOKEN_EOF, "", 0, 0, 0)); // Token dummy
 
-    while (!check(parser, TOKEN_EOF)) {
-        add_child(program_node, statement(parser));
+    while (program_node != NULL && !check(parser, TOKEN_EOF)) {
+        ASTNode* stmt = statement(parser);
+        if (stmt == NULL) {
+            break;
+        }
+        if (!add_child(parser, program_node, stmt)) {
+            free_ast(parser->allocator, stmt);
+            break;
+        }
     }
 
-    consume(parser, TOKEN_EOF, "Esperado fim de arquivo.");
+    // O token atual (EOF ou o token que causou o erro) ainda pertence ao parser
+    token_free(parser->allocator, &parser->current_token);
+
+    if (parser->error.has_error) {
+        free_ast(parser->allocator, program_node);
+        return NULL;
+    }
     return program_node;
 }
-
-
-
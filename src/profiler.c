@@ -0,0 +1,408 @@
+
+/* profiler.c */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "profiler.h"
+#include "parser.h"
+
+// Quantidade de linhas exibidas no relatório
+#define PROFILER_TOP_LINES 20
+
+// Função auxiliar para ler o relógio monotônico em nanossegundos
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Função para inicializar o profiler
+void profiler_init(Profiler* profiler) {
+    memset(profiler, 0, sizeof(Profiler));
+    profiler->root.type = NODE_PROGRAM;
+    profiler->root.file = -1;
+    profiler->current_file = -1;
+}
+
+// Função auxiliar para liberar recursivamente a árvore de chamadas
+static void free_frames(ProfileFrame* frame) {
+    ProfileFrame* child = frame->first_child;
+    while (child != NULL) {
+        ProfileFrame* next = child->next_sibling;
+        free_frames(child);
+        free(child);
+        child = next;
+    }
+    free(frame->children);
+}
+
+// Função para liberar a memória do profiler
+void profiler_free(Profiler* profiler) {
+    free_frames(&profiler->root);
+    free(profiler->by_line);
+    for (int i = 0; i < profiler->num_files; i++) {
+        free(profiler->files[i]);
+    }
+    free(profiler->files);
+    free(profiler->stack);
+    free(profiler->memos);
+    profiler_init(profiler);
+}
+
+// Função para informar o arquivo do código que passa a executar
+void profiler_set_file(Profiler* profiler, const char* file) {
+    profiler->current_file = -1;
+    if (file == NULL) {
+        return;
+    }
+    for (int i = 0; i < profiler->num_files; i++) {
+        if (strcmp(profiler->files[i], file) == 0) {
+            profiler->current_file = i;
+            return;
+        }
+    }
+    // Sem memória para guardar o nome, as linhas ficam no programa principal
+    if (profiler->num_files == profiler->file_capacity) {
+        int capacity = profiler->file_capacity == 0 ? 8 : profiler->file_capacity * 2;
+        char** files = (char**)realloc(profiler->files, capacity * sizeof(char*));
+        if (files == NULL) {
+            return;
+        }
+        profiler->files = files;
+        profiler->file_capacity = capacity;
+    }
+    size_t length = strlen(file) + 1;
+    char* copy = (char*)malloc(length);
+    if (copy == NULL) {
+        return;
+    }
+    memcpy(copy, file, length);
+    profiler->files[profiler->num_files] = copy;
+    profiler->current_file = profiler->num_files++;
+}
+
+// Função auxiliar para espalhar (tipo, arquivo, linha) numa tabela hash
+static unsigned int key_hash(int type, int file, int line) {
+    return ((unsigned int)line * 2654435761u) ^ ((unsigned int)(file + 1) * 40503u) ^ ((unsigned int)type << 20);
+}
+
+// Função auxiliar para colocar um filho na tabela hash do pai (que tem vaga)
+static void insert_child(ProfileFrame* parent, ProfileFrame* child) {
+    unsigned int mask = (unsigned int)parent->child_capacity - 1;
+    unsigned int i = key_hash(child->type, child->file, child->line) & mask;
+    while (parent->children[i] != NULL) {
+        i = (i + 1) & mask;
+    }
+    parent->children[i] = child;
+}
+
+// Função auxiliar para encontrar (ou criar) o filho de um frame
+static ProfileFrame* child_frame(ProfileFrame* parent, NodeType type, int file, int line) {
+    if (parent->child_capacity > 0) {
+        unsigned int mask = (unsigned int)parent->child_capacity - 1;
+        for (unsigned int i = key_hash(type, file, line) & mask; parent->children[i] != NULL; i = (i + 1) & mask) {
+            ProfileFrame* child = parent->children[i];
+            if (child->type == type && child->line == line && child->file == file) {
+                return child;
+            }
+        }
+    }
+
+    // A tabela dobra ao passar de 3/4 de ocupação
+    if ((parent->num_children + 1) * 4 > parent->child_capacity * 3) {
+        int capacity = parent->child_capacity == 0 ? 4 : parent->child_capacity * 2;
+        ProfileFrame** children = (ProfileFrame**)calloc(capacity, sizeof(ProfileFrame*));
+        if (children == NULL) {
+            return NULL;
+        }
+        free(parent->children);
+        parent->children = children;
+        parent->child_capacity = capacity;
+        for (ProfileFrame* child = parent->first_child; child != NULL; child = child->next_sibling) {
+            insert_child(parent, child);
+        }
+    }
+
+    ProfileFrame* child = (ProfileFrame*)calloc(1, sizeof(ProfileFrame));
+    if (child == NULL) {
+        return NULL;
+    }
+    child->type = type;
+    child->file = file;
+    child->line = line;
+    child->parent = parent;
+    child->next_sibling = parent->first_child;
+    parent->first_child = child;
+    parent->num_children++;
+    insert_child(parent, child);
+    return child;
+}
+
+// Função chamada ao entrar na avaliação de um nó
+void profiler_enter(Profiler* profiler, const ASTNode* node) {
+    if (profiler->depth == profiler->stack_capacity) {
+        int capacity = profiler->stack_capacity == 0 ? 64 : profiler->stack_capacity * 2;
+        ProfileActivation* stack = (ProfileActivation*)realloc(profiler->stack, capacity * sizeof(ProfileActivation));
+        if (stack == NULL) {
+            // A pilha não cresceu: a ativação é contada apenas como perdida
+            profiler->dropped++;
+            profiler->overflow++;
+            return;
+        }
+        profiler->stack = stack;
+        profiler->stack_capacity = capacity;
+    }
+
+    ProfileFrame* parent = profiler->depth == 0 ? &profiler->root : profiler->stack[profiler->depth - 1].frame;
+    ProfileActivation* activation = &profiler->stack[profiler->depth++];
+    activation->frame = parent != NULL ? child_frame(parent, node->type, profiler->current_file, node->token.line) : NULL;
+    activation->file = profiler->current_file;
+    activation->child_ns = 0;
+    activation->start_ns = now_ns();
+}
+
+// Função auxiliar para dobrar a tabela de linhas; 0 se faltar memória
+static int grow_lines(Profiler* profiler) {
+    int capacity = profiler->line_capacity == 0 ? 256 : profiler->line_capacity * 2;
+    ProfileLine* by_line = (ProfileLine*)malloc(capacity * sizeof(ProfileLine));
+    if (by_line == NULL) {
+        return 0;
+    }
+    for (int i = 0; i < capacity; i++) {
+        by_line[i].line = -1;
+    }
+    unsigned int mask = (unsigned int)capacity - 1;
+    for (int i = 0; i < profiler->line_capacity; i++) {
+        const ProfileLine* old = &profiler->by_line[i];
+        if (old->line < 0) {
+            continue;
+        }
+        unsigned int j = key_hash(0, old->file, old->line) & mask;
+        while (by_line[j].line >= 0) {
+            j = (j + 1) & mask;
+        }
+        by_line[j] = *old;
+    }
+    free(profiler->by_line);
+    profiler->by_line = by_line;
+    profiler->line_capacity = capacity;
+    return 1;
+}
+
+// Função auxiliar para acumular o tempo de uma linha de um arquivo
+static void add_line(Profiler* profiler, int file, int line, long long self_ns) {
+    if (line < 0) {
+        return;
+    }
+    if ((profiler->num_lines + 1) * 4 > profiler->line_capacity * 3 && !grow_lines(profiler)) {
+        profiler->dropped++;
+        return;
+    }
+    unsigned int mask = (unsigned int)profiler->line_capacity - 1;
+    unsigned int i = key_hash(0, file, line) & mask;
+    while (profiler->by_line[i].line >= 0 &&
+           (profiler->by_line[i].line != line || profiler->by_line[i].file != file)) {
+        i = (i + 1) & mask;
+    }
+    ProfileLine* entry = &profiler->by_line[i];
+    if (entry->line < 0) {
+        entry->file = file;
+        entry->line = line;
+        entry->stat.count = 0;
+        entry->stat.self_ns = 0;
+        profiler->num_lines++;
+    }
+    entry->stat.count++;
+    entry->stat.self_ns += self_ns;
+}
+
+// Função chamada ao sair da avaliação do nó mais recente
+void profiler_exit(Profiler* profiler) {
+    if (profiler->overflow > 0) {
+        profiler->overflow--;
+        return;
+    }
+    if (profiler->depth == 0) {
+        return;
+    }
+
+    ProfileActivation* activation = &profiler->stack[--profiler->depth];
+    long long elapsed = now_ns() - activation->start_ns;
+    long long self_ns = elapsed - activation->child_ns;
+    if (profiler->depth > 0) {
+        profiler->stack[profiler->depth - 1].child_ns += elapsed;
+    }
+
+    ProfileFrame* frame = activation->frame;
+    if (frame == NULL) {
+        profiler->dropped++;
+        return;
+    }
+    frame->stat.count++;
+    frame->stat.self_ns += self_ns;
+    profiler->by_type[frame->type].count++;
+    profiler->by_type[frame->type].self_ns += self_ns;
+    add_line(profiler, activation->file, frame->line, self_ns);
+}
+
+// Função para listar no relatório os acertos e faltas do cache de uma função
+void profiler_add_memo(Profiler* profiler, const char* name, const MemoStats* stats) {
+    if (profiler->num_memos == profiler->memo_capacity) {
+        int capacity = profiler->memo_capacity == 0 ? 8 : profiler->memo_capacity * 2;
+        ProfileMemo* memos = (ProfileMemo*)realloc(profiler->memos, capacity * sizeof(ProfileMemo));
+        if (memos == NULL) {
+            return;
+        }
+        profiler->memos = memos;
+        profiler->memo_capacity = capacity;
+    }
+    profiler->memos[profiler->num_memos].name = name;
+    profiler->memos[profiler->num_memos].stats = stats;
+    profiler->num_memos++;
+}
+
+// Largura da coluna de nomes na tabela de memoização
+#define MEMO_NAME_WIDTH 14
+
+// Função auxiliar para a largura de printf que ocupa width colunas com um
+// texto UTF-8 (printf conta bytes; cada byte de continuação não ocupa coluna)
+static int column_width(const char* text, int width) {
+    for (const char* c = text; *c != '\0'; c++) {
+        if (((unsigned char)*c & 0xC0) == 0x80) {
+            width++;
+        }
+    }
+    return width;
+}
+
+// Entrada do relatório (chave = tipo de nó ou linha)
+typedef struct {
+    int key;
+    int file; // Só para linhas: índice em Profiler.files, ou -1
+    ProfileStat stat;
+} ReportEntry;
+
+static int compare_entries(const void* a, const void* b) {
+    const ReportEntry* x = (const ReportEntry*)a;
+    const ReportEntry* y = (const ReportEntry*)b;
+    if (x->stat.self_ns != y->stat.self_ns) {
+        return x->stat.self_ns < y->stat.self_ns ? 1 : -1;
+    }
+    if (x->file != y->file) {
+        return x->file - y->file;
+    }
+    return x->key - y->key;
+}
+
+// Função para imprimir o relatório de pontos quentes, ordenado por tempo
+void profiler_report(const Profiler* profiler, FILE* out) {
+    long long total_ns = 0;
+    ReportEntry types[NODE_TYPE_COUNT];
+    int num_types = 0;
+    for (int i = 0; i < NODE_TYPE_COUNT; i++) {
+        if (profiler->by_type[i].count > 0) {
+            types[num_types].key = i;
+            types[num_types].file = -1;
+            types[num_types].stat = profiler->by_type[i];
+            total_ns += profiler->by_type[i].self_ns;
+            num_types++;
+        }
+    }
+    double total = total_ns > 0 ? (double)total_ns : 1.0;
+    qsort(types, num_types, sizeof(ReportEntry), compare_entries);
+
+    fprintf(out, "=== Perfil de execução ===\n");
+    fprintf(out, "Tempo total: %.3f ms\n\n", total_ns / 1e6);
+    fprintf(out, "Por tipo de nó:\n");
+    fprintf(out, "  %-14s %14s %14s %7s\n", "tipo", "execuções", "tempo (ms)", "%");
+    for (int i = 0; i < num_types; i++) {
+        fprintf(out, "  %-14s %12lld %14.3f %6.2f%%\n", node_type_name((NodeType)types[i].key),
+                types[i].stat.count, types[i].stat.self_ns / 1e6, 100.0 * types[i].stat.self_ns / total);
+    }
+
+    int num_lines = 0;
+    ReportEntry* lines = NULL;
+    if (profiler->num_lines > 0) {
+        lines = (ReportEntry*)malloc(profiler->num_lines * sizeof(ReportEntry));
+    }
+    if (lines != NULL) {
+        for (int i = 0; i < profiler->line_capacity; i++) {
+            const ProfileLine* line = &profiler->by_line[i];
+            if (line->line >= 0) {
+                lines[num_lines].key = line->line;
+                lines[num_lines].file = line->file;
+                lines[num_lines].stat = line->stat;
+                num_lines++;
+            }
+        }
+        qsort(lines, num_lines, sizeof(ReportEntry), compare_entries);
+    }
+
+    fprintf(out, "\nLinhas mais quentes:\n");
+    fprintf(out, "  %-14s %14s %14s %7s\n", "linha", "execuções", "tempo (ms)", "%");
+    for (int i = 0; i < num_lines && i < PROFILER_TOP_LINES; i++) {
+        // Linhas de módulos importados levam o caminho do arquivo
+        char label[256];
+        if (lines[i].file >= 0) {
+            snprintf(label, sizeof(label), "%s:%d", profiler->files[lines[i].file], lines[i].key);
+        } else {
+            snprintf(label, sizeof(label), "%d", lines[i].key);
+        }
+        fprintf(out, "  %-14s %12lld %14.3f %6.2f%%\n", label,
+                lines[i].stat.count, lines[i].stat.self_ns / 1e6, 100.0 * lines[i].stat.self_ns / total);
+    }
+    free(lines);
+
+    if (profiler->num_memos > 0) {
+        fprintf(out, "\nMemoização (funções puras):\n");
+        fprintf(out, "  %-*s %12s %12s %12s %7s\n", column_width("função", MEMO_NAME_WIDTH), "função",
+                "acertos", "faltas", "descartes", "acerto");
+        for (int i = 0; i < profiler->num_memos; i++) {
+            const MemoStats* stats = profiler->memos[i].stats;
+            long long lookups = stats->hits + stats->misses;
+            const char* name = profiler->memos[i].name;
+            fprintf(out, "  %-*s %12lld %12lld %12lld %6.2f%%\n", column_width(name, MEMO_NAME_WIDTH), name,
+                    stats->hits, stats->misses, stats->evictions, lookups > 0 ? 100.0 * stats->hits / lookups : 0.0);
+        }
+    }
+
+    if (profiler->dropped > 0) {
+        fprintf(out, "\nAviso: %lld ativações não registradas por falta de memória.\n", profiler->dropped);
+    }
+}
+
+// Função auxiliar para escrever o caminho de um frame (raiz primeiro)
+static void write_path(FILE* out, const Profiler* profiler, const ProfileFrame* frame) {
+    if (frame->parent != NULL && frame->parent->parent != NULL) {
+        write_path(out, profiler, frame->parent);
+        fputc(';', out);
+    }
+    if (frame->file >= 0) {
+        fprintf(out, "%s:%s:%d", node_type_name(frame->type), profiler->files[frame->file], frame->line);
+    } else {
+        fprintf(out, "%s:%d", node_type_name(frame->type), frame->line);
+    }
+}
+
+// Função auxiliar para escrever recursivamente as pilhas de um frame
+static void write_folded(FILE* out, const Profiler* profiler, const ProfileFrame* frame) {
+    for (const ProfileFrame* child = frame->first_child; child != NULL; child = child->next_sibling) {
+        if (child->stat.self_ns > 0) {
+            write_path(out, profiler, child);
+            fprintf(out, " %lld\n", child->stat.self_ns);
+        }
+        write_folded(out, profiler, child);
+    }
+}
+
+// Função para gravar as pilhas no formato "folded" (flamegraph.pl)
+int profiler_write_folded(const Profiler* profiler, const char* path) {
+    FILE* out = fopen(path, "w");
+    if (out == NULL) {
+        return 0;
+    }
+    write_folded(out, profiler, &profiler->root);
+    return fclose(out) == 0;
+}
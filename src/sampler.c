@@ -0,0 +1,262 @@
+
+/* sampler.c */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/time.h>
+#include "sampler.h"
+#include "parser.h"
+
+// Capacidades pré-alocadas (o tratador de sinal não pode chamar malloc)
+#define SAMPLER_POOL_FRAMES 65536
+#define SAMPLER_STACKS 8192 // Potência de 2
+
+// Quantidade de pilhas exibidas no resumo
+#define SAMPLER_TOP_STACKS 10
+
+// SIGPROF e setitimer são globais ao processo: só um sampler fica ativo
+static Sampler* volatile active_sampler = NULL;
+static struct sigaction previous_action;
+
+// Função para inicializar o sampler
+int sampler_init(Sampler* sampler, int hz) {
+    memset(sampler, 0, sizeof(Sampler));
+    sampler->hz = hz > 0 ? hz : 100;
+    sampler->pool = (SampleFrame*)malloc(SAMPLER_POOL_FRAMES * sizeof(SampleFrame));
+    sampler->stacks = (SampleStack*)malloc(SAMPLER_STACKS * sizeof(SampleStack));
+    if (sampler->pool == NULL || sampler->stacks == NULL) {
+        sampler_free(sampler);
+        return 0;
+    }
+    sampler->pool_capacity = SAMPLER_POOL_FRAMES;
+    sampler->stack_capacity = SAMPLER_STACKS;
+    for (int i = 0; i < SAMPLER_STACKS; i++) {
+        sampler->stacks[i].depth = -1; // Entrada vazia
+    }
+    return 1;
+}
+
+// Função para liberar a memória do sampler
+void sampler_free(Sampler* sampler) {
+    free(sampler->pool);
+    free(sampler->stacks);
+    sampler->pool = NULL;
+    sampler->stacks = NULL;
+    sampler->pool_capacity = 0;
+    sampler->stack_capacity = 0;
+}
+
+// Função auxiliar para comparar um frame amostrado com um frame da pilha-sombra
+static int same_frame(const SampleFrame* sample, const ShadowFrame* frame) {
+    if (sample->type != frame->type || sample->line != frame->line) {
+        return 0;
+    }
+    const char* name = frame->name != NULL ? frame->name : "";
+    int i = 0;
+    while (i < SAMPLER_NAME_MAX - 1 && name[i] != '\0') {
+        if (sample->name[i] != name[i]) {
+            return 0;
+        }
+        i++;
+    }
+    return sample->name[i] == '\0';
+}
+
+// Registra a pilha atual; roda dentro do tratador, então só usa memória pré-alocada
+static void record_sample(Sampler* sampler) {
+    const ShadowStack* shadow = &sampler->shadow;
+    int depth = shadow->depth;
+    if (depth > SHADOW_STACK_MAX) {
+        depth = SHADOW_STACK_MAX;
+    }
+    if (depth < 0) {
+        depth = 0;
+    }
+
+    // Hash FNV-1a sobre tipo, linha e nome de cada frame
+    unsigned int hash = 2166136261u;
+    for (int i = 0; i < depth; i++) {
+        const ShadowFrame* frame = &shadow->frames[i];
+        hash = (hash ^ (unsigned int)frame->type) * 16777619u;
+        hash = (hash ^ (unsigned int)frame->line) * 16777619u;
+        for (const char* c = frame->name; c != NULL && *c != '\0'; c++) {
+            hash = (hash ^ (unsigned char)*c) * 16777619u;
+        }
+    }
+
+    int mask = sampler->stack_capacity - 1;
+    for (int probe = 0; probe < sampler->stack_capacity; probe++) {
+        SampleStack* entry = &sampler->stacks[(hash + probe) & mask];
+        if (entry->depth < 0) {
+            // Nova pilha: copia os frames para o pool
+            if (sampler->num_stacks >= sampler->stack_capacity * 3 / 4 ||
+                sampler->pool_used + depth > sampler->pool_capacity) {
+                break;
+            }
+            SampleFrame* frames = &sampler->pool[sampler->pool_used];
+            for (int i = 0; i < depth; i++) {
+                const ShadowFrame* frame = &shadow->frames[i];
+                frames[i].type = frame->type;
+                frames[i].line = frame->line;
+                int n = 0;
+                for (const char* c = frame->name; c != NULL && *c != '\0' && n < SAMPLER_NAME_MAX - 1; c++) {
+                    frames[i].name[n++] = *c;
+                }
+                frames[i].name[n] = '\0';
+            }
+            entry->hash = hash;
+            entry->offset = sampler->pool_used;
+            entry->count = 1;
+            entry->depth = depth;
+            sampler->pool_used += depth;
+            sampler->num_stacks++;
+            sampler->samples++;
+            return;
+        }
+        if (entry->hash == hash && entry->depth == depth) {
+            int equal = 1;
+            for (int i = 0; i < depth && equal; i++) {
+                equal = same_frame(&sampler->pool[entry->offset + i], &shadow->frames[i]);
+            }
+            if (equal) {
+                entry->count++;
+                sampler->samples++;
+                return;
+            }
+        }
+    }
+    sampler->dropped++;
+}
+
+// Tratador de SIGPROF
+static void sigprof_handler(int signo) {
+    (void)signo;
+    Sampler* sampler = active_sampler;
+    if (sampler == NULL) {
+        return;
+    }
+    int saved_errno = errno;
+    record_sample(sampler);
+    errno = saved_errno;
+}
+
+// Função para instalar o tratador de SIGPROF e iniciar o temporizador
+int sampler_start(Sampler* sampler) {
+    if (active_sampler != NULL || sampler->stacks == NULL) {
+        return 0;
+    }
+    active_sampler = sampler;
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = sigprof_handler;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(SIGPROF, &action, &previous_action) != 0) {
+        active_sampler = NULL;
+        return 0;
+    }
+
+    struct itimerval timer;
+    long interval_us = 1000000L / sampler->hz;
+    if (interval_us < 1) {
+        interval_us = 1;
+    }
+    timer.it_interval.tv_sec = interval_us / 1000000L;
+    timer.it_interval.tv_usec = interval_us % 1000000L;
+    timer.it_value = timer.it_interval;
+    if (setitimer(ITIMER_PROF, &timer, NULL) != 0) {
+        sigaction(SIGPROF, &previous_action, NULL);
+        active_sampler = NULL;
+        return 0;
+    }
+    return 1;
+}
+
+// Função para parar o temporizador e restaurar o tratador anterior
+void sampler_stop(Sampler* sampler) {
+    if (active_sampler != sampler) {
+        return;
+    }
+    struct itimerval timer;
+    memset(&timer, 0, sizeof(timer));
+    setitimer(ITIMER_PROF, &timer, NULL);
+    sigaction(SIGPROF, &previous_action, NULL);
+    active_sampler = NULL;
+}
+
+// Função auxiliar para escrever o rótulo de um frame amostrado
+static void write_frame(FILE* out, const SampleFrame* frame) {
+    const char* label = frame->name[0] != '\0' ? frame->name : node_type_name((NodeType)frame->type);
+    fprintf(out, "%s:%d", label, frame->line);
+}
+
+static int compare_counts(const void* a, const void* b) {
+    const SampleStack* x = *(const SampleStack* const*)a;
+    const SampleStack* y = *(const SampleStack* const*)b;
+    if (x->count != y->count) {
+        return x->count < y->count ? 1 : -1;
+    }
+    return 0;
+}
+
+// Função para imprimir um resumo das amostras
+void sampler_report(const Sampler* sampler, FILE* out) {
+    fprintf(out, "=== Perfil por amostragem ===\n");
+    fprintf(out, "Amostras: %lld a %d Hz (perdidas: %lld), pilhas distintas: %d\n",
+            sampler->samples, sampler->hz, sampler->dropped, sampler->num_stacks);
+    if (sampler->num_stacks == 0) {
+        return;
+    }
+
+    const SampleStack** order = (const SampleStack**)malloc(sampler->num_stacks * sizeof(SampleStack*));
+    if (order == NULL) {
+        return;
+    }
+    int n = 0;
+    for (int i = 0; i < sampler->stack_capacity; i++) {
+        if (sampler->stacks[i].depth >= 0) {
+            order[n++] = &sampler->stacks[i];
+        }
+    }
+    qsort(order, n, sizeof(SampleStack*), compare_counts);
+
+    fprintf(out, "\nPilhas mais frequentes (frame mais interno):\n");
+    for (int i = 0; i < n && i < SAMPLER_TOP_STACKS; i++) {
+        fprintf(out, "  %10lld %6.2f%%  ", order[i]->count, 100.0 * order[i]->count / sampler->samples);
+        if (order[i]->depth == 0) {
+            fprintf(out, "(fora do interpretador)");
+        } else {
+            write_frame(out, &sampler->pool[order[i]->offset + order[i]->depth - 1]);
+        }
+        fprintf(out, " [profundidade %d]\n", order[i]->depth);
+    }
+    free(order);
+}
+
+// Função para gravar as pilhas amostradas no formato "folded"
+int sampler_write_folded(const Sampler* sampler, const char* path) {
+    FILE* out = fopen(path, "w");
+    if (out == NULL) {
+        return 0;
+    }
+    for (int i = 0; i < sampler->stack_capacity; i++) {
+        const SampleStack* stack = &sampler->stacks[i];
+        if (stack->depth < 0) {
+            continue;
+        }
+        if (stack->depth == 0) {
+            fprintf(out, "(fora do interpretador)");
+        }
+        for (int f = 0; f < stack->depth; f++) {
+            if (f > 0) {
+                fputc(';', out);
+            }
+            write_frame(out, &sampler->pool[stack->offset + f]);
+        }
+        fprintf(out, " %lld\n", stack->count);
+    }
+    return fclose(out) == 0;
+}
@@ -0,0 +1,139 @@
+
+/* tracer.c */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include "tracer.h"
+
+// Função para ler o relógio usado nos eventos, em nanossegundos
+long long trace_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Função para inicializar o tracer
+void tracer_init(Tracer* tracer, int ring_events) {
+    tracer->rings = NULL;
+    tracer->ring_events = ring_events > 0 ? ring_events : TRACE_RING_EVENTS;
+    tracer->origin_ns = trace_now();
+}
+
+// Função para liberar os anéis do tracer
+void tracer_free(Tracer* tracer) {
+    TraceRing* ring = tracer->rings;
+    while (ring != NULL) {
+        TraceRing* next = ring->next;
+        free(ring);
+        ring = next;
+    }
+    tracer->rings = NULL;
+}
+
+// Função para obter (ou criar) o anel da thread atual
+TraceRing* tracer_thread_ring(Tracer* tracer) {
+    int tid = (int)syscall(SYS_gettid);
+    TraceRing* head = __atomic_load_n(&tracer->rings, __ATOMIC_ACQUIRE);
+    for (TraceRing* ring = head; ring != NULL; ring = ring->next) {
+        if (ring->tid == tid) {
+            return ring;
+        }
+    }
+
+    TraceRing* ring = (TraceRing*)calloc(1, sizeof(TraceRing) + tracer->ring_events * sizeof(TraceEvent));
+    if (ring == NULL) {
+        return NULL;
+    }
+    ring->tid = tid;
+    ring->capacity = tracer->ring_events;
+
+    // Inserção lock-free no início da lista; anéis nunca são removidos antes de tracer_free
+    ring->next = head;
+    while (!__atomic_compare_exchange_n(&tracer->rings, &ring->next, ring, 0,
+                                        __ATOMIC_RELEASE, __ATOMIC_ACQUIRE)) {
+        // ring->next foi atualizado com o novo início da lista; tenta de novo
+    }
+    return ring;
+}
+
+// Função para registrar um intervalo no anel
+void trace_span(TraceRing* ring, const char* name, const char* category,
+                long long start_ns, long long end_ns, const char* detail) {
+    if (ring == NULL) {
+        return;
+    }
+    unsigned long long head = ring->head;
+    TraceEvent* event = &ring->events[head % (unsigned long long)ring->capacity];
+    event->name = name;
+    event->category = category;
+    event->start_ns = start_ns;
+    event->duration_ns = end_ns - start_ns;
+    if (detail != NULL) {
+        strncpy(event->detail, detail, TRACE_DETAIL_MAX - 1);
+        event->detail[TRACE_DETAIL_MAX - 1] = '\0';
+    } else {
+        event->detail[0] = '\0';
+    }
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+}
+
+// Função auxiliar para escrever uma string JSON com escapes
+static void write_json_string(FILE* out, const char* s) {
+    fputc('"', out);
+    for (const unsigned char* c = (const unsigned char*)s; *c != '\0'; c++) {
+        if (*c == '"' || *c == '\\') {
+            fputc('\\', out);
+            fputc(*c, out);
+        } else if (*c < 0x20) {
+            fprintf(out, "\\u%04x", *c);
+        } else {
+            fputc(*c, out);
+        }
+    }
+    fputc('"', out);
+}
+
+// Função para gravar todos os anéis em JSON (Chrome Trace Event Format)
+int tracer_write(const Tracer* tracer, const char* path) {
+    FILE* out = fopen(path, "w");
+    if (out == NULL) {
+        return 0;
+    }
+
+    int pid = (int)getpid();
+    unsigned long long dropped = 0;
+    int first = 1;
+    fprintf(out, "{\"traceEvents\":[\n");
+    TraceRing* rings = __atomic_load_n(&tracer->rings, __ATOMIC_ACQUIRE);
+    for (const TraceRing* ring = rings; ring != NULL; ring = ring->next) {
+        fprintf(out, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"rody-%d\"}}",
+                first ? "" : ",\n", pid, ring->tid, ring->tid);
+        first = 0;
+
+        unsigned long long head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        unsigned long long capacity = (unsigned long long)ring->capacity;
+        unsigned long long start = head > capacity ? head - capacity : 0;
+        dropped += start;
+        for (unsigned long long i = start; i < head; i++) {
+            const TraceEvent* event = &ring->events[i % capacity];
+            fprintf(out, ",\n{\"name\":");
+            write_json_string(out, event->name);
+            fprintf(out, ",\"cat\":");
+            write_json_string(out, event->category);
+            fprintf(out, ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%d",
+                    (event->start_ns - tracer->origin_ns) / 1e3, event->duration_ns / 1e3, pid, ring->tid);
+            if (event->detail[0] != '\0') {
+                fprintf(out, ",\"args\":{\"detalhe\":");
+                write_json_string(out, event->detail);
+                fputc('}', out);
+            }
+            fputc('}', out);
+        }
+    }
+    fprintf(out, "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"eventos_perdidos\":%llu}}\n", dropped);
+    return fclose(out) == 0;
+}
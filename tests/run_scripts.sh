@@ -0,0 +1,48 @@
+#!/bin/sh
+# Roda cada scripts/NOME.ry que tem um NOME.out e compara a saída (stdout e
+# stderr juntos) com ele. NOME.in, se existir, vira a entrada padrão e
+# NOME.args traz opções extras para o interpretador. Scripts sem .out são
+# módulos importados pelos testes. Tudo roda numa cópia temporária da pasta,
+# para os arquivos gravados pelos scripts não sujarem a árvore.
+#
+# Uso: tests/run_scripts.sh ./rody [NOME...]
+
+if [ $# -lt 1 ]; then
+    echo "Uso: $0 <rody> [NOME...]" >&2
+    exit 2
+fi
+rody=$(cd "$(dirname "$1")" && pwd)/$(basename "$1")
+shift
+scripts=$(cd "$(dirname "$0")/scripts" && pwd)
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT INT TERM
+cp -R "$scripts"/. "$work"
+
+if [ $# -eq 0 ]; then
+    set -- $(cd "$scripts" && ls *.out | sed 's/\.out$//')
+fi
+
+total=0
+failed=0
+for name in "$@"; do
+    total=$((total + 1))
+    args=""
+    if [ -f "$work/$name.args" ]; then
+        args=$(cat "$work/$name.args")
+    fi
+    input=/dev/null
+    if [ -f "$work/$name.in" ]; then
+        input="$work/$name.in"
+    fi
+    (cd "$work" && "$rody" $args "$name.ry" < "$input" > "$name.actual" 2>&1)
+    if cmp -s "$work/$name.out" "$work/$name.actual"; then
+        echo "ok    $name"
+    else
+        echo "FALHA $name"
+        diff -u "$work/$name.out" "$work/$name.actual" | sed 's/^/    /'
+        failed=$((failed + 1))
+    fi
+done
+
+echo "$((total - failed))/$total scripts ok"
+[ $failed -eq 0 ]
@@ -0,0 +1,656 @@
+
+/* test_api.c */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+#include "librody.h"
+#include "profiler.h"
+#include "sampler.h"
+
+// Número de threads do teste de instâncias concorrentes
+#define TEST_THREADS 8
+
+static int failures = 0;
+
+// Verifica uma condição e registra a falha sem interromper os outros testes
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "%s:%d: falhou: %s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+// Função auxiliar para avaliar um código e comparar o resultado inteiro,
+// sem tocar no contador global (pode rodar em qualquer thread)
+static int eval_int(RodyVM* vm, const char* source, int expected) {
+    Value value;
+    if (rody_vm_eval(vm, source, &value) != RODY_OK) {
+        return 0;
+    }
+    int ok = value.type == VALUE_INTEGER && value.data.int_val == expected;
+    rody_value_free(vm, value);
+    return ok;
+}
+
+// Função auxiliar para avaliar um código que deve terminar com um inteiro
+static void check_int(RodyVM* vm, const char* source, int expected) {
+    if (!eval_int(vm, source, expected)) {
+        fprintf(stderr, "\"%s\": esperado %d (%s)\n", source, expected, rody_vm_error(vm));
+        failures++;
+    }
+}
+
+// Função auxiliar para ler tudo o que foi escrito em um arquivo temporário
+static void read_all(FILE* file, char* buffer, size_t size) {
+    fflush(file);
+    size_t length = (size_t)pread(fileno(file), buffer, size - 1, 0);
+    buffer[length == (size_t)-1 ? 0 : length] = '\0';
+}
+
+// Avaliação de expressões e valor da última instrução
+static void test_eval(void) {
+    RodyVM* vm = rody_vm_new();
+    CHECK(vm != NULL);
+    check_int(vm, "40 + 2;", 42);
+    check_int(vm, "1; 2; 3;", 3);
+    check_int(vm, "(10 - 4) / 3;", 2);
+    check_int(vm, "7 / 2;", 3);
+    Value value;
+    CHECK(rody_vm_eval(vm, "1.5 + 1;", &value) == RODY_OK);
+    CHECK(value.type == VALUE_FLOAT && value.data.float_val == 2.5f);
+    rody_value_free(vm, value);
+    rody_vm_free(vm);
+}
+
+// Erros de sintaxe e de execução, e a instância continua utilizável depois
+static void test_errors(void) {
+    RodyVM* vm = rody_vm_new();
+    CHECK(rody_vm_eval(vm, "(1 + 2;", NULL) == RODY_ERROR_SYNTAX);
+    CHECK(strstr(rody_vm_error(vm), "linha 1") != NULL);
+    CHECK(rody_vm_eval(vm, "1;\n2 / 0;", NULL) == RODY_ERROR_RUNTIME);
+    CHECK(strstr(rody_vm_error(vm), "linha 2") != NULL);
+    CHECK(strstr(rody_vm_error(vm), "Divisão por zero") != NULL);
+    CHECK(rody_vm_eval(vm, "y = [1][3];", NULL) == RODY_ERROR_RUNTIME);
+    CHECK(strstr(rody_vm_error(vm), "fora dos limites") != NULL);
+    CHECK(rody_vm_eval(vm, "print nao_existe;", NULL) == RODY_ERROR_RUNTIME);
+    check_int(vm, "z = 5; z;", 5);
+    CHECK(rody_vm_error(vm)[0] == '\0');
+    rody_vm_free(vm);
+}
+
+// Duas instâncias não compartilham variáveis
+static void test_isolation(void) {
+    RodyVM* a = rody_vm_new();
+    RodyVM* b = rody_vm_new();
+    check_int(a, "v = 1; v;", 1);
+    check_int(b, "v = 2; v;", 2);
+    check_int(a, "v;", 1);
+    check_int(b, "v;", 2);
+    rody_vm_free(a);
+    rody_vm_free(b);
+}
+
+// Cada backend de alocação: contadores por subsistema e liberação completa
+static void test_allocator(void) {
+    AllocatorBackend backends[] = { ALLOC_SYSTEM, ALLOC_ARENA, ALLOC_DEBUG };
+    char source[512] = "";
+    for (int i = 0; i < 40; i++) {
+        strcat(source, "1 + 1;\n");
+    }
+    strcat(source, "40 + 2;");
+    for (size_t i = 0; i < sizeof(backends) / sizeof(backends[0]); i++) {
+        RodyVM* vm = rody_vm_new_with_backend(backends[i]);
+        CHECK(vm != NULL);
+        const Allocator* allocator = rody_vm_allocator(vm);
+        CHECK(allocator->backend == backends[i]);
+
+        // A tabela de programas da instância (reservada na primeira avaliação)
+        // fica alocada; o resto do parser é temporário
+        const MemStats* lexer = &allocator->stats[MEM_LEXER];
+        const MemStats* parser = &allocator->stats[MEM_PARSER];
+        check_int(vm, "0;", 0);
+        long long kept_allocs = parser->allocs - parser->frees;
+        long long kept_bytes = parser->bytes;
+        check_int(vm, source, 42);
+
+        // Tokens e AST são temporários: tudo o que foi alocado já voltou
+        CHECK(lexer->allocs > 0 && lexer->allocs == lexer->frees && lexer->bytes == 0);
+        CHECK(parser->allocs > 0 && parser->allocs - parser->frees == kept_allocs && parser->bytes == kept_bytes);
+        CHECK(parser->reallocs > 0);
+        CHECK(parser->peak_bytes > 0 && parser->total_bytes >= parser->peak_bytes);
+        CHECK(allocator->peak_bytes >= parser->peak_bytes);
+
+        // Uma string devolvida fica em uso até rody_value_free
+        const MemStats* interp = &allocator->stats[MEM_INTERPRETER];
+        Value value;
+        CHECK(rody_vm_eval(vm, "\"texto\";", &value) == RODY_OK);
+        CHECK(value.type == VALUE_STRING && strcmp(value.data.string_val, "texto") == 0);
+        CHECK(interp->bytes >= (long long)sizeof("texto"));
+        rody_value_free(vm, value);
+        CHECK(interp->bytes == 0 && interp->allocs == interp->frees);
+        CHECK(allocator->bytes == kept_bytes);
+        CHECK(allocator->corruptions == 0);
+
+        // Variáveis, estruturas aninhadas e funções em cada backend
+        check_int(vm, "x = 40; x;", 40);
+        check_int(vm, "x + 2;", 42);
+        check_int(vm, "l = [1, 2, 3]; d = {\"k\": l}; d[\"k\"][2];", 3);
+        check_int(vm, "fun soma(n) { s = 0; for i <- 0..n { s = s + i; } return s; } soma(100);", 4950);
+        CHECK(allocator->corruptions == 0);
+
+        // O relatório de --mem-stats traz o backend e cada subsistema
+        FILE* out = tmpfile();
+        CHECK(out != NULL);
+        mem_stats_write(allocator, fileno(out));
+        char report[4096];
+        read_all(out, report, sizeof(report));
+        CHECK(strstr(report, allocator_backend_name(backends[i])) != NULL);
+        CHECK(strstr(report, "lexer") != NULL && strstr(report, "parser") != NULL);
+        fclose(out);
+        rody_vm_free(vm);
+    }
+}
+
+// Saída redirecionada: formatação do print, buffer cheio e erro no meio
+static void test_output(void) {
+    RodyVM* vm = rody_vm_new();
+    FILE* out = tmpfile();
+    CHECK(out != NULL);
+    rody_vm_set_output(vm, fileno(out), 0);
+    CHECK(rody_vm_eval(vm, "print 1, tab, 2.5, br, color red, \"x\", br;", NULL) == RODY_OK);
+    static char buffer[128 * 1024];
+    read_all(out, buffer, sizeof(buffer));
+    CHECK(strcmp(buffer, "1\t2.5\nx\n") == 0);
+
+    // O que foi impresso antes de um erro de execução também é entregue
+    CHECK(rody_vm_eval(vm, "print \"antes\", br; 1 / 0;", NULL) == RODY_ERROR_RUNTIME);
+    read_all(out, buffer, sizeof(buffer));
+    CHECK(strcmp(buffer, "1\t2.5\nx\nantes\n") == 0);
+    fclose(out);
+
+    // Mais que o buffer inteiro numa avaliação: nada se perde
+    out = tmpfile();
+    rody_vm_set_output(vm, fileno(out), 1);
+    static char source[128 * 1024];
+    source[0] = '\0';
+    for (int i = 0; i < 5000; i++) {
+        strcat(source + i * 26, "print \"0123456789abcdef\";\n");
+    }
+    CHECK(rody_vm_eval(vm, source, NULL) == RODY_OK);
+    read_all(out, buffer, sizeof(buffer));
+    CHECK(strlen(buffer) == 5000 * 16);
+    CHECK(strncmp(buffer + 4999 * 16, "0123456789abcdef", 16) == 0);
+    rody_vm_free(vm);
+    fclose(out);
+}
+
+// Entrada trocada: get tipado, em lote e entrada inválida
+static void test_input(void) {
+    RodyVM* vm = rody_vm_new();
+    FILE* out = tmpfile();
+    FILE* in = tmpfile();
+    CHECK(out != NULL && in != NULL);
+    fputs("7\n8\nabc\nx\ny\nz\n", in);
+    fflush(in);
+    lseek(fileno(in), 0, SEEK_SET);
+    rody_vm_set_output(vm, fileno(out), 0);
+    rody_vm_set_input(vm, fileno(in));
+    check_int(vm, "get int a; get int b; a * 10 + b;", 78);
+    CHECK(rody_vm_eval(vm, "get s; print s, br;", NULL) == RODY_OK);
+    CHECK(rody_vm_eval(vm, "get int n;", NULL) == RODY_ERROR_RUNTIME);
+    CHECK(strstr(rody_vm_error(vm), "'x'") != NULL);
+    // Uma quantidade com '*' é uma expressão; só o '*' sozinho lê tudo
+    CHECK(rody_vm_eval(vm, "get string um, 1 * 1; get string resto, *; print um, \"|\", resto, br;", NULL) == RODY_OK);
+    char buffer[256];
+    read_all(out, buffer, sizeof(buffer));
+    CHECK(strcmp(buffer, "abc\ny|z\n") == 0);
+    rody_vm_free(vm);
+    fclose(out);
+    fclose(in);
+}
+
+// Imports: execução única, rejeição de ciclos e erros de módulo só ao executar
+static void test_imports(void) {
+    FILE* file = fopen("modulo.ry", "w");
+    fputs("print \"modulo\", br;", file);
+    fclose(file);
+    file = fopen("ciclo_a.ry", "w");
+    fputs("import ciclo_b;", file);
+    fclose(file);
+    file = fopen("ciclo_b.ry", "w");
+    fputs("import ciclo_a;", file);
+    fclose(file);
+    file = fopen("contador.ry", "w");
+    fputs("n = n + 1;", file);
+    fclose(file);
+
+    RodyVM* vm = rody_vm_new();
+    FILE* out = tmpfile();
+    CHECK(out != NULL);
+    rody_vm_set_output(vm, fileno(out), 0);
+    rody_vm_set_import_path(vm, ".");
+    CHECK(rody_vm_eval(vm, "import modulo; import modulo;", NULL) == RODY_OK);
+    CHECK(rody_vm_eval(vm, "import modulo;", NULL) == RODY_OK);
+    char buffer[256];
+    read_all(out, buffer, sizeof(buffer));
+    CHECK(strcmp(buffer, "modulo\n") == 0);
+    check_int(vm, "n = 0; import contador; import contador; n;", 1);
+
+    // Os alocadores dos módulos entram nas estatísticas da instância somados à parte
+    const Allocator* allocator = rody_vm_allocator(vm);
+    const Allocator* modules = rody_vm_modules_allocator(vm);
+    CHECK(modules->stats[MEM_LEXER].allocs > 0 && modules->stats[MEM_PARSER].allocs > 0);
+    CHECK(modules->bytes > 0 && modules->bytes == modules->stats[MEM_LEXER].bytes + modules->stats[MEM_PARSER].bytes);
+    Allocator sum;
+    allocator_init(&sum, ALLOC_SYSTEM);
+    mem_stats_merge(&sum, allocator);
+    mem_stats_merge(&sum, modules);
+    CHECK(sum.stats[MEM_PARSER].allocs == allocator->stats[MEM_PARSER].allocs + modules->stats[MEM_PARSER].allocs);
+    CHECK(sum.bytes == allocator->bytes + modules->bytes);
+    CHECK(sum.peak_bytes == allocator->peak_bytes + modules->peak_bytes);
+    allocator_free(&sum);
+    CHECK(rody_vm_eval(vm, "import ciclo_a;", NULL) == RODY_ERROR_IMPORT);
+    CHECK(strstr(rody_vm_error(vm), "circular") != NULL);
+    CHECK(rody_vm_eval(vm, "import falta;", NULL) == RODY_ERROR_IMPORT);
+    CHECK(strstr(rody_vm_error(vm), "falta.ry") != NULL);
+
+    // Um módulo com erro só falha quando o import dele executa
+    file = fopen("quebrado.ry", "w");
+    fputs("(1 + ;", file);
+    fclose(file);
+    check_int(vm, "if 1 == 0 { import quebrado; } 7;", 7);
+    CHECK(rody_vm_eval(vm, "import quebrado;", NULL) == RODY_ERROR_IMPORT);
+    CHECK(strstr(rody_vm_error(vm), "quebrado.ry") != NULL && strstr(rody_vm_error(vm), "linha 1") != NULL);
+    CHECK(rody_vm_eval(vm, "1 / 0;", NULL) == RODY_ERROR_RUNTIME);
+    rody_vm_free(vm);
+    fclose(out);
+}
+
+// Intervalos, pipelines fundidos, loop e precedência dos operadores
+static void test_ranges(void) {
+    RodyVM* vm = rody_vm_new();
+    check_int(vm, "s = 0; for x <- (0..10).map(x: x * x).filter(x: x > 10) { s = s + x; } s;", 16 + 25 + 36 + 49 + 64 + 81);
+    check_int(vm, "l = (0..5).map(x: x * 2); l[4];", 8);
+    check_int(vm, "n = 0; loop 7 { n = n + 1; } n;", 7);
+    check_int(vm, "n = 0; for i <- 3..3 { n = n + 1; } n;", 0);
+    check_int(vm, "n = 0; for i <- 0..2 * 3 { n = n + 1; } n;", 6);
+    check_int(vm, "2 * 3 + 1;", 7);
+    CHECK(rody_vm_eval(vm, "n<-1;", NULL) == RODY_ERROR_SYNTAX);
+    CHECK(strstr(rody_vm_error(vm), "'<-'") != NULL);
+    rody_vm_free(vm);
+}
+
+// Ida e volta por save/load e arquivos inválidos
+static void test_save_load(void) {
+    RodyVM* vm = rody_vm_new();
+    CHECK(rody_vm_eval(vm, "d = {\"a\": 0..50, \"b\": [1.5, \"s\", {\"c\": 3}]}; save d -> \"d.bin\";", NULL) == RODY_OK);
+    check_int(vm, "e = load \"d.bin\"; e[\"a\"][49] + e[\"b\"][2][\"c\"];", 52);
+    check_int(vm, "f = e[\"a\"]; e = 0; f[10];", 10);
+
+    FILE* file = fopen("lixo.bin", "w");
+    fputs("isto não é um arquivo rody", file);
+    fclose(file);
+    CHECK(rody_vm_eval(vm, "x = load \"lixo.bin\";", NULL) == RODY_ERROR_RUNTIME);
+
+    // Arquivo cortado no meio
+    file = fopen("d.bin", "rb");
+    char data[4096];
+    size_t length = fread(data, 1, sizeof(data), file);
+    fclose(file);
+    file = fopen("cortado.bin", "wb");
+    fwrite(data, 1, length / 2, file);
+    fclose(file);
+    CHECK(rody_vm_eval(vm, "x = load \"cortado.bin\";", NULL) == RODY_ERROR_RUNTIME);
+    CHECK(rody_vm_eval(vm, "x = load \"nao_existe.bin\";", NULL) == RODY_ERROR_RUNTIME);
+
+    // Caminho válido, mas longo demais para o nome do arquivo temporário:
+    // erro, em vez de gravar num nome truncado
+    char source[1200] = "save 1 -> \"";
+    for (int i = 0; i < 510; i++) {
+        strcat(source, "./");
+    }
+    strcat(source, "longo.bin\";");
+    CHECK(rody_vm_eval(vm, source, NULL) == RODY_ERROR_RUNTIME);
+    CHECK(access("longo.bin", F_OK) != 0);
+
+    // Cada byte trocado: a carga falha com erro ou devolve um valor que pode
+    // ser percorrido inteiro (a saída vai para /dev/null)
+    FILE* null_out = fopen("/dev/null", "w");
+    rody_vm_set_output(vm, fileno(null_out), 0);
+    int rejected = 0;
+    for (size_t i = 0; i < length; i++) {
+        for (int pattern = 0; pattern < 3; pattern++) {
+            char corrupt[4096];
+            memcpy(corrupt, data, length);
+            corrupt[i] = pattern == 0 ? (char)~data[i] : pattern == 1 ? (char)(data[i] + 8) : 0;
+            if (corrupt[i] == data[i]) {
+                continue;
+            }
+            file = fopen("corrompido.bin", "wb");
+            fwrite(corrupt, 1, length, file);
+            fclose(file);
+            RodyStatus status = rody_vm_eval(vm, "x = load \"corrompido.bin\"; print x; x = 0;", NULL);
+            CHECK(status == RODY_OK || status == RODY_ERROR_RUNTIME);
+            rejected += status == RODY_ERROR_RUNTIME;
+        }
+    }
+    CHECK(rejected > 0);
+    rody_vm_free(vm);
+    fclose(null_out);
+}
+
+// Memoização: mesmos resultados com e sem cache, e descarte com cache pequeno
+static void test_memo(void) {
+    const char* source = "fun fib(n) { if n < 2 { return n; } return fib(n - 1) + fib(n - 2); } fib(18);";
+
+    RodyVM* vm = rody_vm_new();
+    rody_vm_set_memo_size(vm, 0);
+    check_int(vm, source, 2584);
+    rody_vm_free(vm);
+
+    Profiler profiler;
+    profiler_init(&profiler);
+    vm = rody_vm_new();
+    rody_vm_set_memo_size(vm, 2);
+    rody_vm_set_profiler(vm, &profiler);
+    check_int(vm, source, 2584);
+    CHECK(profiler.num_memos == 1);
+    if (profiler.num_memos == 1) {
+        CHECK(strcmp(profiler.memos[0].name, "fib") == 0);
+        CHECK(profiler.memos[0].stats->hits > 0);
+        CHECK(profiler.memos[0].stats->evictions > 0);
+    }
+    // Função que lê uma global não é memoizada: o resultado acompanha a global
+    check_int(vm, "k = 1; fun mais_k(x) { return x + k; } a = mais_k(1); k = 10; a + mais_k(1);", 13);
+
+    // Avaliar o mesmo código de novo redefine as funções em vez de falhar
+    check_int(vm, source, 2584);
+    check_int(vm, "fun fib(n) { return n; } fib(18);", 18);
+    rody_vm_free(vm);
+    profiler_free(&profiler);
+}
+
+// Função auxiliar para buscar a estatística de uma linha (file -1 = programa principal)
+static const ProfileStat* line_stat(const Profiler* profiler, int file, int line) {
+    for (int i = 0; i < profiler->line_capacity; i++) {
+        if (profiler->by_line[i].line == line && profiler->by_line[i].file == file) {
+            return &profiler->by_line[i].stat;
+        }
+    }
+    return NULL;
+}
+
+// Profiler: muitos filhos no mesmo frame e linhas separadas por arquivo
+static void test_profiler(void) {
+    Profiler profiler;
+    profiler_init(&profiler);
+    RodyVM* vm = rody_vm_new();
+    rody_vm_set_profiler(vm, &profiler);
+
+    // Cem instruções no mesmo nível: cem filhos distintos do programa, um por linha
+    char source[2048] = "";
+    for (int i = 0; i < 100; i++) {
+        strcat(source, "1 + 1;\n");
+    }
+    strcat(source, "7;");
+    check_int(vm, source, 7);
+    int program_children = 0;
+    for (const ProfileFrame* child = profiler.root.first_child; child != NULL; child = child->next_sibling) {
+        program_children += child->num_children;
+    }
+    CHECK(program_children == 101);
+    for (int line = 1; line <= 101; line++) {
+        const ProfileStat* stat = line_stat(&profiler, -1, line);
+        CHECK(stat != NULL && stat->count == (line <= 100 ? 3 : 1));
+    }
+    CHECK(line_stat(&profiler, -1, 102) == NULL);
+
+    // Avaliar de novo reaproveita os mesmos frames
+    check_int(vm, source, 7);
+    CHECK(profiler.root.first_child != NULL && profiler.root.first_child->num_children == 101);
+    CHECK(profiler.root.first_child != NULL && profiler.root.first_child->stat.count == 2);
+    profiler_free(&profiler);
+
+    // A linha 2 de um módulo não se mistura com a linha 2 do programa
+    FILE* file = fopen("perfil.ry", "w");
+    fputs("1;\n2 + 2;\n3 + 3;\n", file);
+    fclose(file);
+    profiler_init(&profiler);
+    rody_vm_set_profiler(vm, &profiler);
+    rody_vm_set_import_path(vm, ".");
+    check_int(vm, "import perfil;\n5;", 5);
+    CHECK(profiler.num_files == 1);
+    if (profiler.num_files == 1) {
+        CHECK(strstr(profiler.files[0], "perfil.ry") != NULL);
+        const ProfileStat* module_line = line_stat(&profiler, 0, 2);
+        CHECK(module_line != NULL && module_line->count == 3);
+        CHECK(line_stat(&profiler, 0, 3) != NULL);
+        const ProfileStat* main_line = line_stat(&profiler, -1, 2);
+        CHECK(main_line != NULL && main_line->count == 1);
+        CHECK(line_stat(&profiler, -1, 3) == NULL);
+    }
+    profiler_free(&profiler);
+
+    // O corpo de uma função declarada num módulo conta nas linhas do módulo
+    file = fopen("triplo.ry", "w");
+    fputs("fun triplo(x) {\n    return x * 3;\n}\n", file);
+    fclose(file);
+    profiler_init(&profiler);
+    rody_vm_set_profiler(vm, &profiler);
+    rody_vm_set_memo_size(vm, 0);
+    check_int(vm, "import triplo;\nt = 0;\nloop 5 { t = t + triplo(1); }\nt;", 15);
+    CHECK(profiler.num_files == 1);
+    if (profiler.num_files == 1) {
+        const ProfileStat* body = line_stat(&profiler, 0, 2);
+        CHECK(body != NULL && body->count > 0);
+        const ProfileStat* main_line = line_stat(&profiler, -1, 2);
+        CHECK(main_line != NULL && body != NULL && main_line->count != body->count);
+    }
+    rody_vm_free(vm);
+    profiler_free(&profiler);
+}
+
+// Função auxiliar para conferir as pilhas do sampler: nenhuma passa de
+// max_depth; devolve quantas chegam a essa profundidade
+static int sampled_stacks(const Sampler* sampler, int max_depth) {
+    int deepest = 0;
+    for (int i = 0; i < sampler->stack_capacity; i++) {
+        const SampleStack* stack = &sampler->stacks[i];
+        CHECK(stack->depth <= max_depth);
+        deepest += stack->depth == max_depth;
+    }
+    return deepest;
+}
+
+// Sampler: SIGPROF lê a pilha-sombra, que só tem as instruções de nível
+// superior (as subexpressões não viram frames)
+static void test_sampler(void) {
+    static Sampler sampler;
+    CHECK(sampler_init(&sampler, 1000));
+    RodyVM* vm = rody_vm_new();
+    rody_vm_set_sampler(vm, &sampler);
+    char source[8192] = "";
+    for (int i = 0; i < 200; i++) {
+        strcat(source, "((1 + 2) * (3 + 4)) - 5;\n");
+    }
+
+    // Roda até alguma amostra cair dentro de uma instrução (no máximo 5 s)
+    CHECK(sampler_start(&sampler));
+    time_t start = time(NULL);
+    while (sampled_stacks(&sampler, 1) == 0 && time(NULL) - start < 5) {
+        check_int(vm, source, 16);
+    }
+    sampler_stop(&sampler);
+    CHECK(sampler.samples > 0);
+    CHECK(sampled_stacks(&sampler, 1) > 0);
+    CHECK(sampler.shadow.depth == 0);
+    for (int i = 0; i < sampler.stack_capacity; i++) {
+        const SampleStack* stack = &sampler.stacks[i];
+        if (stack->depth == 1) {
+            const SampleFrame* frame = &sampler.pool[stack->offset];
+            CHECK(frame->type == NODE_BINARY_OP && frame->line >= 1 && frame->line <= 200);
+        }
+    }
+    CHECK(sampler_write_folded(&sampler, "amostras.folded"));
+    rody_vm_free(vm);
+    sampler_free(&sampler);
+}
+
+// Função auxiliar para contar os eventos de um nome no anel (com detalhe, se dado)
+static int count_spans(const TraceRing* ring, const char* name, const char* detail) {
+    int found = 0;
+    unsigned long long count = ring->head < (unsigned long long)ring->capacity ? ring->head : (unsigned long long)ring->capacity;
+    for (unsigned long long i = 0; i < count; i++) {
+        const TraceEvent* event = &ring->events[i];
+        found += strcmp(event->name, name) == 0 && (detail == NULL || strcmp(event->detail, detail) == 0);
+    }
+    return found;
+}
+
+// Função de uma thread do teste do tracer: avalia numa instância própria
+static void* trace_thread_main(void* arg) {
+    RodyVM* vm = rody_vm_new();
+    if (vm != NULL) {
+        rody_vm_set_tracer(vm, (Tracer*)arg);
+        rody_vm_eval(vm, "1 + 1;", NULL);
+        rody_vm_free(vm);
+    }
+    return NULL;
+}
+
+// Registro de eventos: análise, execução, save/load e chamadas, um anel por thread
+static void test_trace(void) {
+    Tracer tracer;
+    tracer_init(&tracer, 0);
+    RodyVM* vm = rody_vm_new();
+    rody_vm_set_tracer(vm, &tracer);
+    check_int(vm, "1 + 1;", 2);
+    CHECK(rody_vm_eval(vm, "(1;", NULL) == RODY_ERROR_SYNTAX);
+    TraceRing* ring = tracer_thread_ring(&tracer);
+    CHECK(ring != NULL && ring == tracer_thread_ring(&tracer));
+    CHECK(count_spans(ring, "analise", "lexer+parser") == 2);
+    CHECK(count_spans(ring, "execucao", NULL) == 1);
+
+    // Outra thread ganha um anel só dela
+    pthread_t thread;
+    CHECK(pthread_create(&thread, NULL, trace_thread_main, &tracer) == 0);
+    pthread_join(thread, NULL);
+    int rings = 0;
+    for (const TraceRing* r = tracer.rings; r != NULL; r = r->next) {
+        rings++;
+        CHECK(r == ring || (r->tid != ring->tid && count_spans(r, "execucao", NULL) == 1));
+    }
+    CHECK(rings == 2);
+    CHECK(count_spans(ring, "execucao", NULL) == 1);
+    CHECK(rody_vm_eval(vm, "save [1, 2] -> \"t.bin\"; x = load \"t.bin\";", NULL) == RODY_OK);
+    CHECK(count_spans(ring, "save", "t.bin") == 1);
+    CHECK(count_spans(ring, "load", "t.bin") == 1);
+    check_int(vm, "fun dobro(x) { return x * 2; } dobro(1); dobro(2); dobro(2);", 4);
+    CHECK(count_spans(ring, "chamada", "dobro") == 3);
+    rody_vm_free(vm);
+    tracer_free(&tracer);
+
+    // Anel cheio: os eventos antigos são sobrescritos e contados como perdidos
+    tracer_init(&tracer, 4);
+    vm = rody_vm_new();
+    rody_vm_set_tracer(vm, &tracer);
+    for (int i = 0; i < 5; i++) {
+        check_int(vm, "1;", 1);
+    }
+    CHECK(tracer_thread_ring(&tracer)->head == 10);
+    CHECK(tracer_write(&tracer, "trace.json"));
+    FILE* file = fopen("trace.json", "r");
+    char json[4096];
+    size_t length = file != NULL ? fread(json, 1, sizeof(json) - 1, file) : 0;
+    json[length] = '\0';
+    if (file != NULL) {
+        fclose(file);
+    }
+    CHECK(strncmp(json, "{\"traceEvents\":[", 16) == 0);
+    CHECK(strstr(json, "\"eventos_perdidos\":6") != NULL);
+    rody_vm_free(vm);
+    tracer_free(&tracer);
+}
+
+// Trabalho de uma thread do teste de instâncias concorrentes
+typedef struct {
+    int id;
+    int failed;
+} IsolateJob;
+
+// Função de cada thread: cria a própria instância e avalia várias vezes
+static void* isolate_main(void* arg) {
+    IsolateJob* job = (IsolateJob*)arg;
+    RodyVM* vm = rody_vm_new();
+    if (vm == NULL) {
+        job->failed = 1;
+        return NULL;
+    }
+    char source[64];
+    snprintf(source, sizeof(source), "v = %d; for i <- 0..10 { v = v + 100; } v;", job->id);
+    for (int i = 0; i < 500 && !job->failed; i++) {
+        job->failed = !eval_int(vm, source, job->id + 1000);
+    }
+    // Um erro nesta instância não aparece nas das outras threads
+    if (rody_vm_eval(vm, "1 / 0;", NULL) != RODY_ERROR_RUNTIME) {
+        job->failed = 1;
+    }
+    rody_vm_free(vm);
+    return NULL;
+}
+
+// Instâncias independentes rodando ao mesmo tempo em threads diferentes
+static void test_threads(void) {
+    pthread_t threads[TEST_THREADS];
+    IsolateJob jobs[TEST_THREADS];
+    for (int i = 0; i < TEST_THREADS; i++) {
+        jobs[i].id = i;
+        jobs[i].failed = 0;
+        CHECK(pthread_create(&threads[i], NULL, isolate_main, &jobs[i]) == 0);
+    }
+    for (int i = 0; i < TEST_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+        CHECK(!jobs[i].failed);
+    }
+}
+
+int main(void) {
+    // Os testes gravam arquivos no diretório atual: usa um diretório temporário
+    char dir[] = "/tmp/rody_test_XXXXXX";
+    if (mkdtemp(dir) == NULL || chdir(dir) != 0) {
+        perror("mkdtemp");
+        return 1;
+    }
+
+    test_eval();
+    test_errors();
+    test_isolation();
+    test_allocator();
+    test_output();
+    test_input();
+    test_imports();
+    test_ranges();
+    test_save_load();
+    test_memo();
+    test_profiler();
+    test_sampler();
+    test_trace();
+    test_threads();
+
+    char command[64];
+    snprintf(command, sizeof(command), "rm -rf %s", dir);
+    if (system(command) != 0) {
+        fprintf(stderr, "não foi possível remover %s\n", dir);
+    }
+
+    if (failures > 0) {
+        fprintf(stderr, "%d verificações falharam\n", failures);
+        return 1;
+    }
+    printf("test_api: ok\n");
+    return 0;
+}